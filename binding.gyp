@@ -1,13 +1,22 @@
 {
+  'variables': {
+    # Set to 1 to skip error code bookkeeping in non-throwing APIs.
+    'jsni_fast_api%': 0,
+  },
   'targets': [
     {
       'target_name': 'jsni',
       'type': 'static_library',
       'sources': ['src/jsni.cc'],
+      'conditions': [
+        ['jsni_fast_api==1', {
+          'defines': ['JSNI_FAST_API'],
+        }],
+      ],
     },
     {
       'target_name': 'nativeLoad',
       'sources': ['src/native_load.cc', 'src/jsni-internal.cc'],
     }
   ]
-}
\ No newline at end of file
+}
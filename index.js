@@ -36,7 +36,9 @@ function tryComplete(filename) {
 
 jsni.nativeLoad = function(filename) {
   const Module = require('module');
-  var workPath = require('path').dirname(process.argv[1]);
+  // process.argv[1] is not set in worker threads.
+  var workPath = process.argv[1] ?
+    require('path').dirname(process.argv[1]) : process.cwd();
   searchPaths = [
     workPath + '/build/' + buildType,
   ]
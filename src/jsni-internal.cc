@@ -33,7 +33,27 @@ JSNIEnvExt* JSNIEnvExt::Create(Isolate* isolate) {
 }
 
 JSNIEnvExt::JSNIEnvExt(Isolate* isolate)
-      : isolate_(isolate), error_code(0) {
+      : isolate_(isolate), local_scope_depth(0), error_code(0) {
+}
+
+JSNIEnvExt::~JSNIEnvExt() {
+  while (!cleanup_hooks.empty()) {
+    JSNICleanupHookEntry hook = cleanup_hooks.back();
+    cleanup_hooks.pop_back();
+    hook.fun(hook.arg);
+  }
+  for (auto& it : instance_data) {
+    if (it.second.finalize != nullptr) {
+      it.second.finalize(this, it.second.data, it.second.hint);
+    }
+  }
+  last_exception.Reset();
+  callback_data_template.Reset();
+  typed_array_set.Reset();
+  thrower_template.Reset();
+  for (void* chunk : local_scope_chunks) {
+    operator delete(chunk);
+  }
 }
 
 Isolate* JSNIEnvExt::GetIsolate() {
@@ -30,22 +30,82 @@
 #include "jsni.h"
 #include "v8.h"
 
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace v8 {
 
+// Per native callback state shared by the functions created for it.
+struct JSNIFunctionCache {
+  JSNICallback callback;
+  Global<Value> data;
+  Global<FunctionTemplate> function_template;
+};
+
+// Callbacks of accessors, shared by the accessors using them.
+struct JSNIAccessorCache {
+  JSNICallback getter;
+  JSNICallback setter;
+  // The data object of the accessors without user data.
+  Global<Object> data;
+};
+
+// Data of a native module, see JSNISetInstanceData.
+struct JSNIInstanceData {
+  void* data;
+  JSNIFinalizeCallback finalize;
+  void* hint;
+};
+
+// A class defined by JSNIDefineClass.
+struct JSNIClassCache {
+  // The contents of the descriptor the class is built from.
+  std::string signature;
+  Global<FunctionTemplate> class_template;
+};
+
+struct JSNICleanupHookEntry {
+  JSNICleanupHook fun;
+  void* arg;
+};
+
 struct V8_EXPORT JSNIEnvExt : public _JSNIEnv {
   static JSNIEnvExt* Create(Isolate* isolate);
   Isolate* GetIsolate();
 
   explicit JSNIEnvExt(Isolate* isolate);
+  ~JSNIEnvExt();
   Isolate* const isolate_;
-  // To push/pop local frame.
-  std::vector<void*> stacked_local_scope;
+  // To push/pop local frame. Scopes are constructed in place in chunks of
+  // fixed size slots which are kept for the lifetime of the env.
+  std::vector<void*> local_scope_chunks;
+  size_t local_scope_depth;
   // For error check.
   int error_code;
   JSNIErrorInfo last_error_info;
   Persistent<Value> last_exception;
+  // Template of the data object carried by native functions and accessors.
+  Persistent<ObjectTemplate> callback_data_template;
+  // The builtin %TypedArray%.prototype.set, for bulk array copies.
+  Persistent<Function> typed_array_set;
+  // Template of the function rethrowing exceptions reported as uncaught.
+  Persistent<FunctionTemplate> thrower_template;
+  // Keyed on the JSNICallback pointer.
+  std::unordered_map<void*, JSNIFunctionCache> function_cache;
+  // Keyed on the getter and setter callbacks.
+  std::map<std::pair<void*, void*>, JSNIAccessorCache> accessor_cache;
+  // Interceptors of the classes, at stable addresses.
+  std::deque<JSNIInterceptorDescriptor> interceptors;
+  // Keyed on the constructor callback of the class.
+  std::unordered_map<void*, JSNIClassCache> class_templates;
+  // Keyed on the key chosen by the module owning the data.
+  std::unordered_map<const void*, JSNIInstanceData> instance_data;
+  // Run in reverse order of registration when the env is deleted.
+  std::vector<JSNICleanupHookEntry> cleanup_hooks;
 };
 
 }  // namespace v8
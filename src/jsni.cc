@@ -27,8 +27,20 @@
 #include "jsni-env-ext.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <node.h>
+#include <uv.h>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <limits>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #define LOG_E printf
 
@@ -45,6 +57,12 @@ enum ERROR_CODE {
   OBJERR,
   // Scope error
   SCOERR,
+  // Range error
+  RANERR,
+  // Reference error
+  REFERR,
+  // Class error
+  CLSERR,
 };
 
 const char* error_messages[] =
@@ -55,7 +73,10 @@ const char* error_messages[] =
                 "An Array value is expected",
                 "A String value is expected",
                 "An Object value is expected",
-                "LocalScope is out of range"
+                "LocalScope is out of range",
+                "Offset or length is out of range",
+                "The global value is already deleted",
+                "The class is already defined by another descriptor"
                };
 
 namespace v8 {
@@ -66,11 +87,25 @@ namespace v8 {
 class JSNI {
  public:
   static const int kDataIndex = 0;
-  static const int kGetterIndex = 1;
-  static const int kSetterIndex = 2;
-  static const int kAccessorFieldCount = 3;
+  // An aligned pointer to the JSNIFunctionCache of a native function, or to
+  // the JSNIAccessorCache of an accessor.
+  static const int kCallbackIndex = 1;
+  static const int kEnvIndex = 2;
+  static const int kCallbackDataFieldCount = 3;
   // JSNINewGlobalValue is created with kInitialReferenceCount = 1.
   static const size_t kInitialReferenceCount = 1;
+  // Shorter arrays are copied to native buffers element by element.
+  static const size_t kMinBulkCopyLength = 32;
+  // Handles created by bulk array writers are released in chunks.
+  static const size_t kArrayChunkLength = 1024;
+  // Async work pool size when the number of processors is unknown.
+  static const size_t kDefaultAsyncWorkPoolSize = 4;
+  // Calls of a thread-safe function dispatched per loop wakeup at most.
+  static const size_t kMaxDispatchBatch = 1024;
+  // Local scope slots are allocated in chunks of this many.
+  static const size_t kLocalScopeChunkLength = 64;
+  // Global value slots are allocated in chunks of this many.
+  static const size_t kRefChunkLength = 1024;
 
   class JSNITryCatch : public v8::TryCatch {
    public:
@@ -86,19 +121,61 @@ class JSNI {
     JSNIEnvExt* env_;
   };
 
+  // Room for a scope of either kind.
+  typedef std::aligned_union<0, JsLocalScope, JsEscapableLocalScope>::type
+    LocalScopeSlot;
+
+  static LocalScopeSlot* LocalScopeAt(JSNIEnvExt* env, size_t index) {
+    return static_cast<LocalScopeSlot*>(
+      env->local_scope_chunks[index / kLocalScopeChunkLength]) +
+      index % kLocalScopeChunkLength;
+  }
+
+  // Constructs a scope on top of the stack. Chunks are only allocated the
+  // first time the stack grows to a new depth.
+  template <typename Scope>
+  static void PushLocalScope(JSNIEnvExt* env) {
+    size_t index = env->local_scope_depth;
+    if (index / kLocalScopeChunkLength == env->local_scope_chunks.size()) {
+      env->local_scope_chunks.push_back(
+        operator new(sizeof(LocalScopeSlot) * kLocalScopeChunkLength));
+    }
+    new (LocalScopeAt(env, index)) Scope(env->isolate_);
+    env->local_scope_depth++;
+  }
+
+  static JsLocalScopeBase* TopLocalScope(JSNIEnvExt* env) {
+    return reinterpret_cast<JsLocalScopeBase*>(
+      LocalScopeAt(env, env->local_scope_depth - 1));
+  }
+
+  static void PopLocalScope(JSNIEnvExt* env) {
+    JsLocalScopeBase* scope = TopLocalScope(env);
+    if (scope->IsEscapable()) {
+      static_cast<JsEscapableLocalScope*>(scope)->~JsEscapableLocalScope();
+    } else {
+      static_cast<JsLocalScope*>(scope)->~JsLocalScope();
+    }
+    env->local_scope_depth--;
+  }
+
   class JSRef {
    public:
     static JSRef* New(JSNIEnv* env, JSValueRef ref) {
       Isolate* isolate = JSNI::GetIsolate(env);
       Local<Value> val = JSNI::ToV8LocalValue(ref);
-      return new JSRef(isolate, val);
+      return new JSRef(env, isolate, val);
     }
 
     static void Delete(JSRef* ref) {
       if (ref == nullptr) {
         return;
       }
-      if (ref->callback_ != nullptr) {
+      if (ref->callback_ != nullptr && ref->persistent_.IsEmpty()) {
+        // A weak value already collected, report it right away.
+        ref->callback_(ref->env_, ref->data_);
+        delete ref;
+      } else if (ref->callback_ != nullptr) {
         ref->persistent_.SetWeak(ref, FakeGCCallback, WeakCallbackType::kParameter);
       } else {
         delete ref;
@@ -130,6 +207,31 @@ class JSNI {
       }
     }
 
+    // Lets the GC collect the value, the handle is then reset.
+    void MakeWeak() {
+      if (!persistent_.IsEmpty()) {
+        persistent_.SetWeak();
+      }
+    }
+
+    bool MakeStrong() {
+      if (persistent_.IsEmpty()) {
+        return false;
+      }
+      persistent_.ClearWeak();
+      return true;
+    }
+
+    bool IsAlive() {
+      return !persistent_.IsEmpty();
+    }
+
+    void AttachExternalMemory(size_t size) {
+      external_size_ += size;
+      JSNI::GetIsolate(env_)->AdjustAmountOfExternalAllocatedMemory(
+        static_cast<int64_t>(size));
+    }
+
     size_t Count() {
       return count_;
     }
@@ -150,35 +252,662 @@ class JSNI {
     }
 
    private:
-    JSRef(Isolate* isolate, Local<Value> val)
-         : persistent_(isolate, val),
+    JSRef(JSNIEnv* env, Isolate* isolate, Local<Value> val)
+         : env_(env),
+           persistent_(isolate, val),
            callback_(nullptr),
-           count_(kInitialReferenceCount) {
+           count_(kInitialReferenceCount),
+           external_size_(0) {
     }
 
     ~JSRef() {
       persistent_.Reset();
+      if (external_size_ != 0) {
+        JSNI::GetIsolate(env_)->AdjustAmountOfExternalAllocatedMemory(
+          -static_cast<int64_t>(external_size_));
+      }
     }
 
     static void FakeGCCallback(const WeakCallbackInfo<JSRef>& info) {
-      Isolate* isolate = info.GetIsolate();
-      JSNIEnv* env = JSNI::GetEnv(isolate);
       JSNI::JSRef* ref =
         reinterpret_cast<JSNI::JSRef*>(info.GetParameter());
       assert(ref != nullptr);
       JSNIGCCallback callback = ref->GetCallback();
 
       if (callback != nullptr) {
-        callback(env, ref->GetData());
+        callback(ref->env_, ref->GetData());
       }
       // Reset and delete the global.
       delete ref;
     }
 
+    static void* operator new(size_t size) {
+      return JSRefSlab::Allocate();
+    }
+
+    static void operator delete(void* ptr) {
+      JSRefSlab::Free(ptr);
+    }
+
+    JSNIEnv* env_;
     Persistent<Value> persistent_;
     void* data_;
     JSNIGCCallback callback_;
     size_t count_;
+    size_t external_size_;
+  };
+
+  // Storage of JSRef. Slots are carved out of chunks owned by the thread,
+  // so by the isolate, and recycled through a free list. A slot keeps
+  // whether it is in use, so a deleted global value is detected until its
+  // slot is reused. Chunks are never freed, as global values still held
+  // when the thread exits would be freed underneath V8.
+  class JSRefSlab {
+   public:
+    static void* Allocate() {
+      JSRefSlab& slab = Current();
+      if (slab.free_list_ == nullptr) {
+        slab.Grow();
+      }
+      Slot* slot = slab.free_list_;
+      slab.free_list_ = slot->next;
+      slot->live = true;
+      return slot;
+    }
+
+    static void Free(void* ptr) {
+      JSRefSlab& slab = Current();
+      Slot* slot = static_cast<Slot*>(ptr);
+      slot->live = false;
+      slot->next = slab.free_list_;
+      slab.free_list_ = slot;
+    }
+
+    // Best-effort: a stale value whose slot is reused passes as live.
+    static bool IsLive(JSGlobalValueRef val) {
+      return val != nullptr && reinterpret_cast<Slot*>(val)->live;
+    }
+
+   private:
+    struct Slot {
+      // The JSRef while in use, else the next free slot.
+      union {
+        std::aligned_storage<sizeof(JSRef), alignof(JSRef)>::type ref;
+        Slot* next;
+      };
+      bool live;
+    };
+
+    JSRefSlab() : free_list_(nullptr) {}
+
+    static JSRefSlab& Current() {
+      static thread_local JSRefSlab slab;
+      return slab;
+    }
+
+    void Grow() {
+      Slot* chunk = new Slot[kRefChunkLength];
+      // Thread the free list in address order.
+      for (size_t i = kRefChunkLength; i > 0; i--) {
+        chunk[i - 1].live = false;
+        chunk[i - 1].next = free_list_;
+        free_list_ = &chunk[i - 1];
+      }
+    }
+
+    Slot* free_list_;
+  };
+
+  // Owns the data of an externalized ArrayBuffer and releases it through
+  // the finalize callback once the ArrayBuffer is collected.
+  class ExternalArrayBuffer {
+   public:
+    static Local<ArrayBuffer> New(JSNIEnv* env,
+                                  void* data,
+                                  size_t length,
+                                  JSNIFinalizeCallback callback,
+                                  void* hint) {
+      Isolate* isolate = JSNI::GetIsolate(env);
+      Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, data, length);
+      ExternalArrayBuffer* external =
+        new ExternalArrayBuffer(env, isolate, buffer, data, length, callback, hint);
+      external->persistent_.SetWeak(external,
+                                    FirstPassCallback,
+                                    WeakCallbackType::kParameter);
+      isolate->AdjustAmountOfExternalAllocatedMemory(
+        static_cast<int64_t>(length));
+      return buffer;
+    }
+
+   private:
+    ExternalArrayBuffer(JSNIEnv* env,
+                        Isolate* isolate,
+                        Local<ArrayBuffer> buffer,
+                        void* data,
+                        size_t length,
+                        JSNIFinalizeCallback callback,
+                        void* hint)
+         : env_(env),
+           persistent_(isolate, buffer),
+           data_(data),
+           length_(length),
+           callback_(callback),
+           hint_(hint) {
+    }
+
+    static void FirstPassCallback(
+        const WeakCallbackInfo<ExternalArrayBuffer>& info) {
+      ExternalArrayBuffer* external = info.GetParameter();
+      external->persistent_.Reset();
+      info.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(
+        -static_cast<int64_t>(external->length_));
+      // The finalize callback may call back into JSNI, which is only
+      // allowed in the second pass.
+      info.SetSecondPassCallback(SecondPassCallback);
+    }
+
+    static void SecondPassCallback(
+        const WeakCallbackInfo<ExternalArrayBuffer>& info) {
+      ExternalArrayBuffer* external = info.GetParameter();
+      if (external->callback_ != nullptr) {
+        external->callback_(external->env_, external->data_, external->hint_);
+      }
+      delete external;
+    }
+
+    JSNIEnv* env_;
+    Global<ArrayBuffer> persistent_;
+    void* data_;
+    size_t length_;
+    JSNIFinalizeCallback callback_;
+    void* hint_;
+  };
+
+  // The resource of an external string. V8 disposes it when the string is
+  // collected, which happens inside the GC, so the finalize callback must
+  // not call back into JSNI.
+  template <typename Base, typename Char>
+  class ExternalStringResource : public Base {
+   public:
+    ExternalStringResource(JSNIEnv* env,
+                           const Char* data,
+                           size_t length,
+                           JSNIFinalizeCallback callback,
+                           void* hint)
+         : env_(env),
+           isolate_(JSNI::GetIsolate(env)),
+           data_(data),
+           length_(length),
+           callback_(callback),
+           hint_(hint) {
+    }
+
+    const Char* data() const override {
+      return data_;
+    }
+
+    size_t length() const override {
+      return length_;
+    }
+
+    // Only data released by a callback is owned, and accounted for.
+    int64_t ExternalSize() const {
+      return callback_ == nullptr ? 0
+        : static_cast<int64_t>(length_ * sizeof(Char));
+    }
+
+    void Dispose() override {
+      if (callback_ != nullptr) {
+        isolate_->AdjustAmountOfExternalAllocatedMemory(-ExternalSize());
+        callback_(env_, const_cast<Char*>(data_), hint_);
+      }
+      delete this;
+    }
+
+   private:
+    JSNIEnv* env_;
+    // The env may be gone when the vm is disposed.
+    Isolate* isolate_;
+    const Char* data_;
+    size_t length_;
+    JSNIFinalizeCallback callback_;
+    void* hint_;
+  };
+
+  typedef ExternalStringResource<String::ExternalOneByteStringResource, char>
+    ExternalOneByteResource;
+  typedef ExternalStringResource<String::ExternalStringResource, uint16_t>
+    ExternalTwoByteResource;
+
+  class AsyncWork;
+
+  // The worker threads running async works. The pool is shared by the
+  // process and started by the first queued work.
+  class AsyncWorkPool {
+   public:
+    static AsyncWorkPool* Get() {
+      // Never deleted, the detached workers may outlive static destructors.
+      static AsyncWorkPool* pool = new AsyncWorkPool();
+      return pool;
+    }
+
+    bool SetSize(size_t size) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (started_ || size == 0) {
+        return false;
+      }
+      size_ = size;
+      return true;
+    }
+
+    void Push(AsyncWork* work) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!started_) {
+        for (size_t i = 0; i < size_; i++) {
+          std::thread(&AsyncWorkPool::Run, this).detach();
+        }
+        started_ = true;
+      }
+      queue_.push_back(work);
+      cv_.notify_one();
+    }
+
+    // Returns false if a worker has taken the work.
+    bool Remove(AsyncWork* work) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = std::find(queue_.begin(), queue_.end(), work);
+      if (it == queue_.end()) {
+        return false;
+      }
+      queue_.erase(it);
+      return true;
+    }
+
+    // Returns once no worker is running the work.
+    void Wait(AsyncWork* work) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_cv_.wait(lock, [this, work] {
+        return std::find(running_.begin(), running_.end(), work) ==
+               running_.end();
+      });
+    }
+
+   private:
+    AsyncWorkPool() : size_(std::thread::hardware_concurrency()),
+                      started_(false) {
+      if (size_ == 0) {
+        size_ = kDefaultAsyncWorkPoolSize;
+      }
+    }
+
+    void Run();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::deque<AsyncWork*> queue_;
+    std::vector<AsyncWork*> running_;
+    size_t size_;
+    bool started_;
+  };
+
+  // Runs execute on a worker and posts complete back to the loop thread
+  // through an uv_async_t, which keeps the loop alive meanwhile.
+  class AsyncWork {
+   public:
+    AsyncWork(JSNIEnv* env,
+              JSNIAsyncExecuteCallback execute,
+              JSNIAsyncCompleteCallback complete,
+              void* data)
+         : env_(env),
+           execute_(execute),
+           complete_(complete),
+           data_(data),
+           async_(nullptr),
+           status_(JSNIAsyncCompleted) {
+    }
+
+    bool Queue() {
+      if (async_ != nullptr) {
+        return false;
+      }
+      Isolate* isolate = JSNI::GetIsolate(env_);
+      // Every queueing gets its own handle, as closing the previous one
+      // completes asynchronously.
+      async_ = new uv_async_t;
+      uv_async_init(node::GetCurrentEventLoop(isolate), async_, OnComplete);
+      async_->data = this;
+      context_.Reset(isolate, isolate->GetCurrentContext());
+      status_ = JSNIAsyncCompleted;
+      JSNIAddCleanupHook(env_, OnEnvCleanup, this);
+      AsyncWorkPool::Get()->Push(this);
+      return true;
+    }
+
+    bool Cancel() {
+      if (async_ == nullptr || !AsyncWorkPool::Get()->Remove(this)) {
+        return false;
+      }
+      status_ = JSNIAsyncCancelled;
+      uv_async_send(async_);
+      return true;
+    }
+
+    // Called on a worker thread.
+    void Execute() {
+      execute_(data_);
+      uv_async_send(async_);
+    }
+
+   private:
+    static void OnComplete(uv_async_t* handle) {
+      AsyncWork* work = static_cast<AsyncWork*>(handle->data);
+      uv_close(reinterpret_cast<uv_handle_t*>(handle), OnClose);
+      work->async_ = nullptr;
+      JSNIRemoveCleanupHook(work->env_, OnEnvCleanup, work);
+      // The work may be queued again or deleted in the complete callback.
+      work->Complete();
+    }
+
+    // The handle must not outlive the loop when the env is torn down before
+    // the work completes, e.g. by a worker thread exiting. Works not started
+    // are dropped, running ones are waited for, complete is not called.
+    static void OnEnvCleanup(void* arg) {
+      AsyncWork* work = static_cast<AsyncWork*>(arg);
+      if (!AsyncWorkPool::Get()->Remove(work)) {
+        AsyncWorkPool::Get()->Wait(work);
+      }
+      uv_close(reinterpret_cast<uv_handle_t*>(work->async_), OnClose);
+      work->async_ = nullptr;
+      work->context_.Reset();
+    }
+
+    static void OnClose(uv_handle_t* handle) {
+      delete reinterpret_cast<uv_async_t*>(handle);
+    }
+
+    void Complete() {
+      Isolate* isolate = JSNI::GetIsolate(env_);
+      HandleScope scope(isolate);
+      Local<Context> context = Local<Context>::New(isolate, context_);
+      context_.Reset();
+      if (complete_ == nullptr) {
+        return;
+      }
+      Context::Scope context_scope(context);
+      // Like MakeCallback, runs the microtasks once the callback returns.
+      node::CallbackScope callback_scope(isolate, Object::New(isolate), {0, 0});
+      // The work may be deleted in the complete callback.
+      JSNIEnvExt* env = reinterpret_cast<JSNIEnvExt*>(env_);
+      complete_(env_, status_, data_);
+      ReportLastException(isolate, env);
+    }
+
+    JSNIEnv* env_;
+    JSNIAsyncExecuteCallback execute_;
+    JSNIAsyncCompleteCallback complete_;
+    void* data_;
+    uv_async_t* async_;
+    JSNIAsyncStatus status_;
+    Global<Context> context_;
+  };
+
+  // A multi-producer single-consumer queue. Producers only exchange the
+  // head, the loop thread is the single consumer popping from the tail.
+  class MPSCQueue {
+   public:
+    struct Node {
+      std::atomic<Node*> next;
+      void* data;
+    };
+
+    MPSCQueue() : head_(&stub_), tail_(&stub_) {
+      stub_.next.store(nullptr, std::memory_order_relaxed);
+    }
+
+    void Push(Node* node) {
+      node->next.store(nullptr, std::memory_order_relaxed);
+      Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+      prev->next.store(node, std::memory_order_release);
+    }
+
+    // Returns nullptr if empty, or if a producer is halfway through Push,
+    // whose wakeup then comes after.
+    Node* Pop() {
+      Node* tail = tail_;
+      Node* next = tail->next.load(std::memory_order_acquire);
+      if (tail == &stub_) {
+        if (next == nullptr) {
+          return nullptr;
+        }
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+      }
+      if (next != nullptr) {
+        tail_ = next;
+        return tail;
+      }
+      if (tail != head_.load(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      Push(&stub_);
+      next = tail->next.load(std::memory_order_acquire);
+      if (next != nullptr) {
+        tail_ = next;
+        return tail;
+      }
+      return nullptr;
+    }
+
+   private:
+    std::atomic<Node*> head_;
+    Node* tail_;
+    Node stub_;
+  };
+
+  class ThreadSafeFunction {
+   public:
+    ThreadSafeFunction(JSNIEnv* env,
+                       Local<Value> func,
+                       size_t max_queue_size,
+                       JSNIThreadSafeCallJSCallback call_js,
+                       void* context,
+                       JSNIFinalizeCallback finalize)
+         : env_(env),
+           max_queue_size_(max_queue_size),
+           call_js_(call_js),
+           context_(context),
+           finalize_(finalize),
+           size_(0),
+           waiters_(0),
+           thread_count_(1),
+           closing_(false),
+           wakeup_pending_(false) {
+      Isolate* isolate = JSNI::GetIsolate(env);
+      func_.Reset(isolate, func);
+      v8_context_.Reset(isolate, isolate->GetCurrentContext());
+      uv_async_init(node::GetCurrentEventLoop(isolate), &async_, OnWakeup);
+      async_.data = this;
+      JSNIAddCleanupHook(env, OnEnvCleanup, this);
+    }
+
+    JSNIThreadSafeCallStatus Call(void* data, bool blocking) {
+      for (;;) {
+        if (closing_.load()) {
+          return JSNIThreadSafeClosing;
+        }
+        size_t size = size_.fetch_add(1);
+        if (max_queue_size_ == 0 || size < max_queue_size_) {
+          break;
+        }
+        size_.fetch_sub(1);
+        if (!blocking) {
+          return JSNIThreadSafeQueueFull;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_++;
+        cv_.wait(lock, [this] {
+          return size_.load() < max_queue_size_ || closing_.load();
+        });
+        waiters_--;
+      }
+      MPSCQueue::Node* node = new MPSCQueue::Node;
+      node->data = data;
+      queue_.Push(node);
+      Wakeup();
+      return JSNIThreadSafeOK;
+    }
+
+    bool Acquire() {
+      if (closing_.load()) {
+        return false;
+      }
+      thread_count_.fetch_add(1);
+      return true;
+    }
+
+    void Release() {
+      if (thread_count_.fetch_sub(1) == 1) {
+        closing_.store(true);
+        NotifyWaiters();
+        Wakeup();
+      }
+    }
+
+   private:
+    // Many calls queued before the loop wakes up share one uv_async_send.
+    void Wakeup() {
+      if (!wakeup_pending_.exchange(true)) {
+        uv_async_send(&async_);
+      }
+    }
+
+    void NotifyWaiters() {
+      if (waiters_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv_.notify_all();
+      }
+    }
+
+    static void OnWakeup(uv_async_t* handle) {
+      if (uv_is_closing(reinterpret_cast<uv_handle_t*>(handle))) {
+        return;
+      }
+      ThreadSafeFunction* tsfn = static_cast<ThreadSafeFunction*>(handle->data);
+      tsfn->Dispatch();
+    }
+
+    void Dispatch() {
+      // Calls queued from now on need another wakeup.
+      wakeup_pending_.store(false);
+      Isolate* isolate = JSNI::GetIsolate(env_);
+      HandleScope scope(isolate);
+      Local<Context> context = Local<Context>::New(isolate, v8_context_);
+      Context::Scope context_scope(context);
+      {
+        // One callback scope for the batch, microtasks run once after it.
+        node::CallbackScope callback_scope(isolate, Object::New(isolate),
+                                           {0, 0});
+        Local<Value> func = Local<Value>::New(isolate, func_);
+        for (size_t i = 0; i < kMaxDispatchBatch; i++) {
+          MPSCQueue::Node* node = queue_.Pop();
+          if (node == nullptr) {
+            break;
+          }
+          void* data = node->data;
+          delete node;
+          size_.fetch_sub(1);
+          NotifyWaiters();
+          HandleScope call_scope(isolate);
+          // Exceptions are reported as uncaught after each call, the rest
+          // of the batch still runs if a handler takes them.
+          if (call_js_ != nullptr) {
+            call_js_(env_, JSNI::ToJSNIValue(func), context_, data);
+            ReportLastException(isolate, reinterpret_cast<JSNIEnvExt*>(env_));
+          } else {
+            TryCatch try_catch(isolate);
+            if (func.As<Function>()->Call(context, Undefined(isolate),
+                                          0, nullptr).IsEmpty() &&
+                !try_catch.HasTerminated()) {
+              node::FatalException(isolate, try_catch);
+            }
+          }
+        }
+      }
+      if (size_.load() > 0) {
+        // Leave the loop to other handles, the rest goes in the next round.
+        Wakeup();
+      } else if (closing_.load()) {
+        uv_close(reinterpret_cast<uv_handle_t*>(&async_), OnClose);
+      }
+    }
+
+    static void OnClose(uv_handle_t* handle) {
+      ThreadSafeFunction* tsfn = static_cast<ThreadSafeFunction*>(handle->data);
+      // Already finalized if the env has been torn down.
+      if (tsfn->env_ == nullptr) {
+        delete tsfn;
+        return;
+      }
+      JSNIRemoveCleanupHook(tsfn->env_, OnEnvCleanup, tsfn);
+      if (tsfn->finalize_ != nullptr) {
+        Isolate* isolate = JSNI::GetIsolate(tsfn->env_);
+        HandleScope scope(isolate);
+        Local<Context> context = Local<Context>::New(isolate, tsfn->v8_context_);
+        Context::Scope context_scope(context);
+        node::CallbackScope callback_scope(isolate, Object::New(isolate), {0, 0});
+        tsfn->finalize_(tsfn->env_, tsfn->context_, nullptr);
+        ReportLastException(isolate, reinterpret_cast<JSNIEnvExt*>(tsfn->env_));
+      }
+      delete tsfn;
+    }
+
+    // The handle must not outlive the loop when the env is torn down while
+    // references are held, e.g. by a worker thread exiting. New calls fail,
+    // blocked callers return, queued calls are dropped and the function is
+    // finalized right away. The close callback may run after the isolate is
+    // disposed, so no V8 handle is left to it.
+    static void OnEnvCleanup(void* arg) {
+      ThreadSafeFunction* tsfn = static_cast<ThreadSafeFunction*>(arg);
+      tsfn->closing_.store(true);
+      tsfn->NotifyWaiters();
+      while (MPSCQueue::Node* node = tsfn->queue_.Pop()) {
+        delete node;
+      }
+      if (tsfn->finalize_ != nullptr) {
+        Isolate* isolate = JSNI::GetIsolate(tsfn->env_);
+        HandleScope scope(isolate);
+        Local<Context> context = Local<Context>::New(isolate, tsfn->v8_context_);
+        Context::Scope context_scope(context);
+        tsfn->finalize_(tsfn->env_, tsfn->context_, nullptr);
+      }
+      tsfn->func_.Reset();
+      tsfn->v8_context_.Reset();
+      tsfn->env_ = nullptr;
+      uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(&tsfn->async_);
+      if (!uv_is_closing(handle)) {
+        uv_close(handle, OnClose);
+      }
+    }
+
+    JSNIEnv* env_;
+    Global<Value> func_;
+    Global<Context> v8_context_;
+    size_t max_queue_size_;
+    JSNIThreadSafeCallJSCallback call_js_;
+    void* context_;
+    JSNIFinalizeCallback finalize_;
+    uv_async_t async_;
+    MPSCQueue queue_;
+    // The number of queued calls, counted before they are pushed.
+    std::atomic<size_t> size_;
+    std::atomic<size_t> waiters_;
+    std::atomic<size_t> thread_count_;
+    std::atomic<bool> closing_;
+    std::atomic<bool> wakeup_pending_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
   };
 
   // TODO(jiny) FunctionCallback should use this JSNICallbackInfoWrap.
@@ -190,20 +919,30 @@ class JSNI {
       kGetterProperty = 1 << 1,
       kSetterProperty = 1 << 2,
       kWeakGC = 1 << 3,
+      kInterceptor = 1 << 4,
     } CallbackInfoType;
     JSNICallbackInfoWrap(void* info, CallbackInfoType type)
-                    :info_(info), type_(type) {}
+                    :info_(info), type_(type), value_(nullptr),
+                     property_(nullptr) {}
 
-    JSNICallbackInfoWrap(void* info, CallbackInfoType type, JSValueRef value)
-                    :info_(info), type_(type), value_(value) {}
+    JSNICallbackInfoWrap(void* info, CallbackInfoType type, JSValueRef value,
+                         JSValueRef property = nullptr,
+                         Local<Value>* result = nullptr)
+                    :info_(info), type_(type), value_(value),
+                     property_(property), result_(result) {}
 
     CallbackInfoType type() { return type_;}
     void* info() { return info_;}
     JSValueRef value() { return value_;}
+    JSValueRef property() { return property_;}
+    // Where the return value goes if it is checked before V8 sees it.
+    Local<Value>* result() { return result_;}
    private:
     void* info_;
     CallbackInfoType type_;
     JSValueRef value_;
+    JSValueRef property_;
+    Local<Value>* result_;
   };
 
   static void SetErrorCode(JSNIEnv* env, int error_code) {
@@ -216,47 +955,107 @@ class JSNI {
     jsni_env_ext->error_code = NOERR;
   }
 
+  // Callback data carries the env, so callbacks find it in constant time
+  // instead of looking it up on the global object.
+  static Local<Object> NewCallbackData(JSNIEnv* env) {
+    JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+    Isolate* isolate = jsni_env_ext->isolate_;
+    Local<ObjectTemplate> temp;
+    if (jsni_env_ext->callback_data_template.IsEmpty()) {
+      temp = ObjectTemplate::New(isolate);
+      temp->SetInternalFieldCount(kCallbackDataFieldCount);
+      jsni_env_ext->callback_data_template.Reset(isolate, temp);
+    } else {
+      temp = Local<ObjectTemplate>::New(
+        isolate, jsni_env_ext->callback_data_template);
+    }
+    Local<Object> data =
+      temp->NewInstance(isolate->GetCurrentContext()).ToLocalChecked();
+    data->SetAlignedPointerInInternalField(kEnvIndex, env);
+    return data;
+  }
+
+  static JSNIEnvExt* GetEnvOfCallbackData(Local<Value> data) {
+    return reinterpret_cast<JSNIEnvExt*>(
+      data.As<Object>()->GetAlignedPointerFromInternalField(kEnvIndex));
+  }
+
+  static Local<Value> WrapFunctionData(JSNIEnv* env, JSNIFunctionCache* cache) {
+    Local<Object> external = NewCallbackData(env);
+    external->SetAlignedPointerInInternalField(JSNI::kCallbackIndex, cache);
+    return external;
+  }
+
+  // Functions of the same callback share one data object and template, so
+  // creating them again does not build and leak a new template.
+  // The template is only built when JSNIGetFunction needs it.
+  static JSNIFunctionCache& GetFunctionCache(JSNIEnv* env,
+                                             JSNICallback callback) {
+    JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+    JSNIFunctionCache& cache =
+      jsni_env_ext->function_cache[reinterpret_cast<void*>(callback)];
+    if (cache.data.IsEmpty()) {
+      Isolate* isolate = jsni_env_ext->isolate_;
+      HandleScope scope(isolate);
+      cache.callback = callback;
+      cache.data.Reset(isolate, WrapFunctionData(env, &cache));
+    }
+    return cache;
+  }
+
+  // Instantiates a new function. Unlike FunctionTemplate::GetFunction, the
+  // result is not cached in the context.
+  static Local<Function> NewFunction(JSNIEnv* env, JSNICallback callback) {
+    Isolate* isolate = GetIsolate(env);
+    JSNIFunctionCache& cache = GetFunctionCache(env, callback);
+    return Function::New(isolate->GetCurrentContext(),
+                         FakeJSNICallback,
+                         Local<Value>::New(isolate, cache.data))
+             .ToLocalChecked();
+  }
+
+  // Accessors of the same callbacks share their JSNIAccessorCache, whose
+  // address the data object holds, so calls read the callbacks without
+  // unboxing. Accessors without user data share the data object as well.
   static Local<Value> WrapAccessorData(JSNIEnv* env,
                                 JSNICallback getter,
                                 JSNICallback setter,
                                 void* data) {
-    Isolate* isolate = GetIsolate(env);
-    Local<Context> context = isolate->GetCurrentContext();
-    Local<ObjectTemplate> temp = ObjectTemplate::New(isolate);
-    temp->SetInternalFieldCount(kAccessorFieldCount);
-    Local<Object> external = temp->NewInstance(context).ToLocalChecked();
-
-    if (getter != nullptr) {
-      external->SetInternalField(
-          JSNI::kGetterIndex,
-          External::New(isolate, reinterpret_cast<void*>(getter)));
-    }
-
-    if (setter != nullptr) {
-      external->SetInternalField(
-          JSNI::kSetterIndex,
-          External::New(isolate, reinterpret_cast<void*>(setter)));
+    JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+    Isolate* isolate = jsni_env_ext->isolate_;
+    JSNIAccessorCache& cache = jsni_env_ext->accessor_cache[
+      std::make_pair(reinterpret_cast<void*>(getter),
+                     reinterpret_cast<void*>(setter))];
+    if (data == nullptr && !cache.data.IsEmpty()) {
+      return Local<Object>::New(isolate, cache.data);
     }
-
+    cache.getter = getter;
+    cache.setter = setter;
+    Local<Object> external = NewCallbackData(env);
+    external->SetAlignedPointerInInternalField(JSNI::kCallbackIndex, &cache);
     external->SetInternalField(
         JSNI::kDataIndex,
         External::New(isolate, data));
+    if (data == nullptr) {
+      cache.data.Reset(isolate, external);
+    }
     return external;
   }
 
+  static JSNIAccessorCache* GetAccessorCache(Local<Value> data) {
+    return static_cast<JSNIAccessorCache*>(
+      data.As<Object>()->GetAlignedPointerFromInternalField(kCallbackIndex));
+  }
+
   // Getter wrap.
   static void WrapGetter(Local<Name> property,
                          const PropertyCallbackInfo<Value>& info) {
-    Isolate* isolate = info.GetIsolate();
-    JSNIEnv* env = JSNI::GetEnv(isolate);
-    Local<Object> external = info.Data().As<Object>();
-    JSNICallback getter =
-      (JSNICallback)external->GetInternalField(kGetterIndex)
-      .As<External>()->Value();
+    JSNIEnv* env = GetEnvOfCallbackData(info.Data());
+    JSNICallback getter = GetAccessorCache(info.Data())->getter;
 
     JSNICallbackInfoWrap jsni_info(
       reinterpret_cast<void*>(const_cast<PropertyCallbackInfo<Value>*>(&info)),
-      JSNICallbackInfoWrap::kGetterProperty);
+      JSNICallbackInfoWrap::kGetterProperty, nullptr, ToJSNIValue(property));
 
     getter(env, (JSNICallbackInfo)&jsni_info);
   }
@@ -264,39 +1063,40 @@ class JSNI {
   static void WrapSetter(Local<Name> property,
                          Local<Value> value,
                          const PropertyCallbackInfo<void>& info) {
-    Isolate* isolate = info.GetIsolate();
-    JSNIEnv* env = JSNI::GetEnv(isolate);
-    Local<Object> external = info.Data().As<Object>();
-    JSNICallback getter =
-      (JSNICallback)external->GetInternalField(kSetterIndex)
-      .As<External>()->Value();
+    JSNIEnv* env = GetEnvOfCallbackData(info.Data());
+    JSNICallback setter = GetAccessorCache(info.Data())->setter;
 
     JSValueRef jsni_value = ToJSNIValue(value);
     JSNICallbackInfoWrap jsni_info(reinterpret_cast<void*>(
                                 const_cast<PropertyCallbackInfo<void>*>(
                                   &info)),
                                JSNICallbackInfoWrap::kSetterProperty,
-                               jsni_value);
+                               jsni_value,
+                               ToJSNIValue(property));
 
-    getter(env, (JSNICallbackInfo)&jsni_info);
+    setter(env, (JSNICallbackInfo)&jsni_info);
   }
 
   // A fake func to call native callback.
   static void FakeJSNICallback(
                 const FunctionCallbackInfo<Value>& info) {
     Isolate* isolate = info.GetIsolate();
-    JSNICallback nativeFunc =
-      reinterpret_cast<JSNICallback>(
-          info.Data().As<External>()->Value());
+    Local<Object> external = info.Data().As<Object>();
+    JSNICallback nativeFunc = static_cast<JSNIFunctionCache*>(
+      external->GetAlignedPointerFromInternalField(kCallbackIndex))->callback;
 
-    JSNIEnvExt* env = reinterpret_cast<JSNIEnvExt*>(JSNI::GetEnv(isolate));
+    JSNIEnvExt* env = GetEnvOfCallbackData(external);
 
     JSNICallbackInfoWrap jsni_info(reinterpret_cast<void*>(
                                const_cast<FunctionCallbackInfo<Value>*>(&info)),
       JSNICallbackInfoWrap::kFunction);
 
     nativeFunc(env, (JSNICallbackInfo)&jsni_info);
-    // exception is caught by us. If not empty, throw it here.
+    RethrowLastException(isolate, env);
+  }
+
+  // exception is caught by us. If not empty, throw it here.
+  static void RethrowLastException(Isolate* isolate, JSNIEnvExt* env) {
     if (!env->last_exception.IsEmpty()) {
       isolate->ThrowException(
           v8::Local<v8::Value>::New(isolate, env->last_exception));
@@ -304,6 +1104,556 @@ class JSNI {
     }
   }
 
+  static void ThrowArgument(const FunctionCallbackInfo<Value>& info) {
+    info.GetIsolate()->ThrowException(info[0]);
+  }
+
+  // No JS frame is left to throw into after callbacks invoked from the
+  // loop, so an exception caught by us is reported as uncaught instead.
+  // It is thrown from a JS frame, which leaves nothing scheduled on the
+  // isolate once caught.
+  static void ReportLastException(Isolate* isolate, JSNIEnvExt* env) {
+    if (env->last_exception.IsEmpty()) {
+      return;
+    }
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Value> exception = Local<Value>::New(isolate, env->last_exception);
+    env->last_exception.Reset();
+    Local<FunctionTemplate> temp;
+    if (env->thrower_template.IsEmpty()) {
+      temp = FunctionTemplate::New(isolate, ThrowArgument);
+      env->thrower_template.Reset(isolate, temp);
+    } else {
+      temp = Local<FunctionTemplate>::New(isolate, env->thrower_template);
+    }
+    TryCatch try_catch(isolate);
+    Local<Function> thrower;
+    if (temp->GetFunction(context).ToLocal(&thrower) &&
+        thrower->Call(context, Undefined(isolate), 1, &exception).IsEmpty()) {
+      node::FatalException(isolate, try_catch);
+    }
+  }
+
+  static Local<Value> WrapInterceptorData(
+      JSNIEnv* env, const JSNIInterceptorDescriptor* descriptor) {
+    JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+    jsni_env_ext->interceptors.push_back(*descriptor);
+    Local<Object> external = NewCallbackData(env);
+    external->SetAlignedPointerInInternalField(
+        JSNI::kCallbackIndex, &jsni_env_ext->interceptors.back());
+    external->SetInternalField(
+        JSNI::kDataIndex,
+        External::New(jsni_env_ext->isolate_, descriptor->data));
+    return external;
+  }
+
+  static JSNIInterceptorDescriptor* GetInterceptor(Local<Value> data) {
+    return static_cast<JSNIInterceptorDescriptor*>(
+      data.As<Object>()->GetAlignedPointerFromInternalField(kCallbackIndex));
+  }
+
+  // Calls an interceptor callback. The value is only given to setters.
+  template <typename T>
+  static void CallInterceptor(JSNICallback callback,
+                              Local<Value> property,
+                              Local<Value> value,
+                              const PropertyCallbackInfo<T>& info) {
+    JSNIEnvExt* env = GetEnvOfCallbackData(info.Data());
+    JSNICallbackInfoWrap jsni_info(
+      reinterpret_cast<void*>(const_cast<PropertyCallbackInfo<T>*>(&info)),
+      JSNICallbackInfoWrap::kInterceptor,
+      value.IsEmpty() ? nullptr : ToJSNIValue(value),
+      property.IsEmpty() ? nullptr : ToJSNIValue(property));
+    callback(env, (JSNICallbackInfo)&jsni_info);
+    RethrowLastException(info.GetIsolate(), env);
+  }
+
+  // Calls a query, deleter or enumerator callback. V8 trusts their return
+  // values to be of type T, so a value failing the check throws instead.
+  template <typename T>
+  static void CallTypedInterceptor(JSNICallback callback,
+                                   Local<Value> property,
+                                   bool (Value::*check)() const,
+                                   const char* error,
+                                   const PropertyCallbackInfo<T>& info) {
+    Isolate* isolate = info.GetIsolate();
+    JSNIEnvExt* env = GetEnvOfCallbackData(info.Data());
+    Local<Value> result;
+    JSNICallbackInfoWrap jsni_info(
+      reinterpret_cast<void*>(const_cast<PropertyCallbackInfo<T>*>(&info)),
+      JSNICallbackInfoWrap::kInterceptor,
+      nullptr,
+      property.IsEmpty() ? nullptr : ToJSNIValue(property),
+      &result);
+    callback(env, (JSNICallbackInfo)&jsni_info);
+    if (!env->last_exception.IsEmpty()) {
+      RethrowLastException(isolate, env);
+      return;
+    }
+    if (result.IsEmpty()) {
+      return;
+    }
+    if (!((*result)->*check)()) {
+      isolate->ThrowException(Exception::TypeError(
+        String::NewFromUtf8(isolate, error,
+                            NewStringType::kNormal).ToLocalChecked()));
+      return;
+    }
+    info.GetReturnValue().Set(result.As<T>());
+  }
+
+  static void NamedGetter(Local<Name> property,
+                          const PropertyCallbackInfo<Value>& info) {
+    CallInterceptor(GetInterceptor(info.Data())->getter,
+                    property, Local<Value>(), info);
+  }
+
+  static void NamedSetter(Local<Name> property,
+                          Local<Value> value,
+                          const PropertyCallbackInfo<Value>& info) {
+    CallInterceptor(GetInterceptor(info.Data())->setter,
+                    property, value, info);
+  }
+
+  static void NamedQuery(Local<Name> property,
+                         const PropertyCallbackInfo<Integer>& info) {
+    CallTypedInterceptor(GetInterceptor(info.Data())->query,
+                         property, &Value::IsInt32,
+                         "Interceptor query must return an int32", info);
+  }
+
+  static void NamedDeleter(Local<Name> property,
+                           const PropertyCallbackInfo<Boolean>& info) {
+    CallTypedInterceptor(GetInterceptor(info.Data())->deleter,
+                         property, &Value::IsBoolean,
+                         "Interceptor deleter must return a boolean", info);
+  }
+
+  static void Enumerator(const PropertyCallbackInfo<Array>& info) {
+    CallTypedInterceptor(GetInterceptor(info.Data())->enumerator,
+                         Local<Value>(), &Value::IsArray,
+                         "Interceptor enumerator must return an array", info);
+  }
+
+  static void IndexedGetter(uint32_t index,
+                            const PropertyCallbackInfo<Value>& info) {
+    CallInterceptor(GetInterceptor(info.Data())->getter,
+                    Integer::NewFromUnsigned(info.GetIsolate(), index),
+                    Local<Value>(), info);
+  }
+
+  static void IndexedSetter(uint32_t index,
+                            Local<Value> value,
+                            const PropertyCallbackInfo<Value>& info) {
+    CallInterceptor(GetInterceptor(info.Data())->setter,
+                    Integer::NewFromUnsigned(info.GetIsolate(), index),
+                    value, info);
+  }
+
+  static void IndexedQuery(uint32_t index,
+                           const PropertyCallbackInfo<Integer>& info) {
+    CallTypedInterceptor(GetInterceptor(info.Data())->query,
+                         Integer::NewFromUnsigned(info.GetIsolate(), index),
+                         &Value::IsInt32,
+                         "Interceptor query must return an int32", info);
+  }
+
+  static void IndexedDeleter(uint32_t index,
+                             const PropertyCallbackInfo<Boolean>& info) {
+    CallTypedInterceptor(GetInterceptor(info.Data())->deleter,
+                         Integer::NewFromUnsigned(info.GetIsolate(), index),
+                         &Value::IsBoolean,
+                         "Interceptor deleter must return a boolean", info);
+  }
+
+  static void SetTemplateInterceptors(
+      JSNIEnv* env,
+      Local<ObjectTemplate> temp,
+      const JSNIInterceptorDescriptor* named,
+      const JSNIInterceptorDescriptor* indexed) {
+    if (named != nullptr) {
+      temp->SetHandler(NamedPropertyHandlerConfiguration(
+        named->getter ? NamedGetter : nullptr,
+        named->setter ? NamedSetter : nullptr,
+        named->query ? NamedQuery : nullptr,
+        named->deleter ? NamedDeleter : nullptr,
+        named->enumerator ? Enumerator : nullptr,
+        WrapInterceptorData(env, named),
+        PropertyHandlerFlags::kOnlyInterceptStrings));
+    }
+    if (indexed != nullptr) {
+      temp->SetHandler(IndexedPropertyHandlerConfiguration(
+        indexed->getter ? IndexedGetter : nullptr,
+        indexed->setter ? IndexedSetter : nullptr,
+        indexed->query ? IndexedQuery : nullptr,
+        indexed->deleter ? IndexedDeleter : nullptr,
+        indexed->enumerator ? Enumerator : nullptr,
+        WrapInterceptorData(env, indexed)));
+    }
+  }
+
+  // Class constructors throw instead of running on an arbitrary receiver.
+  static void FakeJSNIConstructor(
+                const FunctionCallbackInfo<Value>& info) {
+    if (!info.IsConstructCall()) {
+      Isolate* isolate = info.GetIsolate();
+      isolate->ThrowException(Exception::TypeError(
+        String::NewFromUtf8(isolate,
+                            "Class constructor cannot be invoked without 'new'",
+                            NewStringType::kNormal).ToLocalChecked()));
+      return;
+    }
+    FakeJSNICallback(info);
+  }
+
+  template <typename T>
+  static void AppendSignature(std::string* signature, T value) {
+    signature->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  static void AppendSignature(std::string* signature, const char* name) {
+    if (name != nullptr) {
+      signature->append(name);
+    }
+    signature->push_back('\0');
+  }
+
+  static void AppendSignature(std::string* signature,
+                              const JSNIAccessorDescriptor* accessors,
+                              size_t count) {
+    AppendSignature(signature, count);
+    for (size_t i = 0; i < count; i++) {
+      AppendSignature(signature, accessors[i].name);
+      AppendSignature(signature, accessors[i].getter);
+      AppendSignature(signature, accessors[i].setter);
+      AppendSignature(signature, accessors[i].attributes);
+      AppendSignature(signature, accessors[i].data);
+    }
+  }
+
+  static void AppendSignature(std::string* signature,
+                              const JSNIInterceptorDescriptor* interceptor) {
+    AppendSignature(signature, interceptor != nullptr);
+    if (interceptor != nullptr) {
+      AppendSignature(signature, interceptor->getter);
+      AppendSignature(signature, interceptor->setter);
+      AppendSignature(signature, interceptor->query);
+      AppendSignature(signature, interceptor->deleter);
+      AppendSignature(signature, interceptor->enumerator);
+      AppendSignature(signature, interceptor->data);
+    }
+  }
+
+  // Everything a class template is built from, so that defining a cached
+  // class again by another descriptor is detected.
+  static std::string ClassSignature(const JSNIClassDescriptor* descriptor) {
+    std::string signature;
+    AppendSignature(&signature, descriptor->name);
+    AppendSignature(&signature, descriptor->internal_field_count);
+    AppendSignature(&signature, descriptor->method_count);
+    for (size_t i = 0; i < descriptor->method_count; i++) {
+      AppendSignature(&signature, descriptor->methods[i].name);
+      AppendSignature(&signature, descriptor->methods[i].callback);
+      AppendSignature(&signature, descriptor->methods[i].attributes);
+    }
+    AppendSignature(&signature, descriptor->accessors,
+                    descriptor->accessor_count);
+    AppendSignature(&signature, descriptor->instance_accessors,
+                    descriptor->instance_accessor_count);
+    AppendSignature(&signature, descriptor->named_interceptor);
+    AppendSignature(&signature, descriptor->indexed_interceptor);
+    return signature;
+  }
+
+  static Local<FunctionTemplate> NewClassTemplate(
+      JSNIEnv* env, const JSNIClassDescriptor* descriptor) {
+    Isolate* isolate = GetIsolate(env);
+    EscapableHandleScope scope(isolate);
+    Local<FunctionTemplate> temp =
+      FunctionTemplate::New(
+        isolate, FakeJSNIConstructor,
+        Local<Value>::New(isolate,
+                          GetFunctionCache(env, descriptor->constructor).data));
+    temp->SetClassName(
+      String::NewFromUtf8(isolate, descriptor->name,
+                          NewStringType::kInternalized).ToLocalChecked());
+    temp->InstanceTemplate()->SetInternalFieldCount(
+      descriptor->internal_field_count);
+
+    Local<ObjectTemplate> proto = temp->PrototypeTemplate();
+    // Receivers are checked by V8, so callbacks may rely on internal fields.
+    Local<Signature> signature = Signature::New(isolate, temp);
+    for (size_t i = 0; i < descriptor->method_count; i++) {
+      const JSNIMethodDescriptor& method = descriptor->methods[i];
+      Local<FunctionTemplate> method_temp =
+        FunctionTemplate::New(
+          isolate, FakeJSNICallback,
+          Local<Value>::New(isolate,
+                            GetFunctionCache(env, method.callback).data),
+          signature);
+      proto->Set(
+        String::NewFromUtf8(isolate, method.name,
+                            NewStringType::kInternalized).ToLocalChecked(),
+        method_temp,
+        static_cast<PropertyAttribute>(method.attributes));
+    }
+
+    Local<AccessorSignature> accessor_signature =
+      AccessorSignature::New(isolate, temp);
+    SetTemplateAccessors(env, proto, accessor_signature,
+                         descriptor->accessors, descriptor->accessor_count);
+    SetTemplateAccessors(env, temp->InstanceTemplate(), accessor_signature,
+                         descriptor->instance_accessors,
+                         descriptor->instance_accessor_count);
+    SetTemplateInterceptors(env, temp->InstanceTemplate(),
+                            descriptor->named_interceptor,
+                            descriptor->indexed_interceptor);
+    return scope.Escape(temp);
+  }
+
+  // Accessors of a template are created once and shared by all the objects
+  // instantiated from it.
+  static void SetTemplateAccessors(JSNIEnv* env,
+                                   Local<ObjectTemplate> temp,
+                                   Local<AccessorSignature> signature,
+                                   const JSNIAccessorDescriptor* accessors,
+                                   size_t count) {
+    Isolate* isolate = GetIsolate(env);
+    for (size_t i = 0; i < count; i++) {
+      const JSNIAccessorDescriptor& accessor = accessors[i];
+      temp->SetAccessor(
+        String::NewFromUtf8(isolate, accessor.name,
+                            NewStringType::kInternalized).ToLocalChecked(),
+        accessor.getter ? WrapGetter : NULL,
+        accessor.setter ? WrapSetter : NULL,
+        WrapAccessorData(env, accessor.getter, accessor.setter, accessor.data),
+        AccessControl::DEFAULT,
+        static_cast<PropertyAttribute>(accessor.attributes),
+        signature);
+    }
+  }
+
+  // A property key is a strong persistent handle of an internalized string.
+  static Local<Name> ToV8Name(JSNIPropertyKey key) {
+    return *reinterpret_cast<Local<Name>*>(
+      reinterpret_cast<Persistent<Name>*>(key));
+  }
+
+  // Accessors may pass the data object made by WrapAccessorData, to share
+  // it between several properties.
+  static bool DefineProperty(JSNIEnv* env,
+                             JSValueRef object,
+                             Local<Name> pro_name,
+                             const JSNIPropertyDescriptor descriptor,
+                             Local<Value> wrap_data = Local<Value>()) {
+    Isolate* isolate = GetIsolate(env);
+    Local<Context> context = isolate->GetCurrentContext();
+    JSNIDataPropertyDescriptor* data_attributes =
+      descriptor.data_attributes;
+    JSNIAccessorPropertyDescriptor* accessor_attributes =
+      descriptor.accessor_attributes;
+    Local<Object> obj = ToV8LocalValue(object).As<Object>();
+
+    CHECK(data_attributes == NULL || accessor_attributes == NULL);
+    if (accessor_attributes != NULL) {
+      CHECK(data_attributes == NULL);
+      JSNICallback getter = accessor_attributes->getter;
+      JSNICallback setter = accessor_attributes->setter;
+
+      if (wrap_data.IsEmpty()) {
+        wrap_data =
+          WrapAccessorData(env, getter, setter, accessor_attributes->data);
+      }
+
+      bool result = obj->SetAccessor(
+        context,
+        pro_name,
+        getter ? WrapGetter : NULL,
+        setter ? WrapSetter : NULL,
+        wrap_data,
+        AccessControl::DEFAULT,
+        static_cast<PropertyAttribute>(accessor_attributes->attributes))
+          .FromMaybe(false);
+      return result;
+    } else {
+      CHECK(accessor_attributes == NULL);
+      PropertyAttribute attributes =
+        static_cast<PropertyAttribute>(data_attributes->attributes);
+      bool result =
+        obj->DefineOwnProperty(context,
+                               pro_name,
+                               ToV8LocalValue(data_attributes->value),
+                               attributes).FromMaybe(false);
+      return result;
+    }
+  }
+
+  // Returns 0 for JsArrayTypeNone and unknown types.
+  static size_t TypedArrayElementSize(JsTypedArrayType type) {
+    switch (type) {
+      case JsArrayTypeInt8:
+      case JsArrayTypeUint8:
+      case JsArrayTypeUint8Clamped:
+        return 1;
+      case JsArrayTypeInt16:
+      case JsArrayTypeUint16:
+        return 2;
+      case JsArrayTypeInt32:
+      case JsArrayTypeUint32:
+      case JsArrayTypeFloat32:
+        return 4;
+      case JsArrayTypeFloat64:
+        return 8;
+      default:
+        return 0;
+    }
+  }
+
+  static Local<TypedArray> NewTypedArray(JsTypedArrayType type,
+                                         Local<ArrayBuffer> buffer,
+                                         size_t byte_offset,
+                                         size_t length) {
+    switch (type) {
+      case JsArrayTypeInt8:
+        return Int8Array::New(buffer, byte_offset, length);
+      case JsArrayTypeUint8:
+        return Uint8Array::New(buffer, byte_offset, length);
+      case JsArrayTypeUint8Clamped:
+        return Uint8ClampedArray::New(buffer, byte_offset, length);
+      case JsArrayTypeInt16:
+        return Int16Array::New(buffer, byte_offset, length);
+      case JsArrayTypeUint16:
+        return Uint16Array::New(buffer, byte_offset, length);
+      case JsArrayTypeInt32:
+        return Int32Array::New(buffer, byte_offset, length);
+      case JsArrayTypeUint32:
+        return Uint32Array::New(buffer, byte_offset, length);
+      case JsArrayTypeFloat32:
+        return Float32Array::New(buffer, byte_offset, length);
+      case JsArrayTypeFloat64:
+        return Float64Array::New(buffer, byte_offset, length);
+      default:
+        JSNIAbort(__func__, "UNREACHABLE.");
+    }
+    return Local<TypedArray>();
+  }
+
+  // Copies the first count elements of array into out, converting them like
+  // TypedArray.prototype.set does. That builtin copies arrays with packed
+  // SMI or double elements in bulk and visits holey or dictionary arrays
+  // one element at a time, so short arrays skip the view setup instead.
+  // The builtin %TypedArray%.prototype.set, looked up once per env so that
+  // patching it later runs no user code over the caller's memory.
+  static Local<Function> GetTypedArraySet(JSNIEnvExt* env,
+                                          Local<Context> context,
+                                          Local<TypedArray> view) {
+    Isolate* isolate = env->isolate_;
+    if (env->typed_array_set.IsEmpty()) {
+      Local<Value> proto = view->GetPrototype();
+      Local<Value> set;
+      if (!proto->IsObject()) {
+        return Local<Function>();
+      }
+      proto = proto.As<Object>()->GetPrototype();
+      if (!proto->IsObject() ||
+          !proto.As<Object>()->Get(context, SetString(isolate)).ToLocal(&set) ||
+          !set->IsFunction()) {
+        return Local<Function>();
+      }
+      env->typed_array_set.Reset(isolate, set.As<Function>());
+    }
+    return Local<Function>::New(isolate, env->typed_array_set);
+  }
+
+  static bool CopyArrayToNative(JSNIEnvExt* env,
+                                Local<Array> array,
+                                JsTypedArrayType type,
+                                void* out,
+                                size_t count) {
+    Isolate* isolate = env->isolate_;
+    HandleScope scope(isolate);
+    Local<Context> context = isolate->GetCurrentContext();
+    if (count < kMinBulkCopyLength || count != array->Length()) {
+      for (size_t i = 0; i < count; i++) {
+        Local<Value> val;
+        if (!array->Get(context, static_cast<uint32_t>(i)).ToLocal(&val)) {
+          return false;
+        }
+        // Fails like the bulk copy if a conversion throws.
+        if (type == JsArrayTypeFloat64) {
+          if (!val->NumberValue(context).To(&static_cast<double*>(out)[i])) {
+            return false;
+          }
+        } else {
+          if (!val->Int32Value(context).To(&static_cast<int32_t*>(out)[i])) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+    Local<ArrayBuffer> buffer =
+      ArrayBuffer::New(isolate, out, count * TypedArrayElementSize(type));
+    Local<TypedArray> view = NewTypedArray(type, buffer, 0, count);
+    Local<Function> set = GetTypedArraySet(env, context, view);
+    Local<Value> argv[] = { array };
+    bool success =
+      !set.IsEmpty() && !set->Call(context, view, 1, argv).IsEmpty();
+    // Detach the caller's memory from the heap.
+    buffer->Neuter();
+    return success;
+  }
+
+  template <typename T, typename V>
+  static Local<Array> NewArrayFromNative(Isolate* isolate,
+                                         const T* data,
+                                         size_t length) {
+    EscapableHandleScope scope(isolate);
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Array> array = Array::New(isolate, 0);
+    for (size_t start = 0; start < length; start += kArrayChunkLength) {
+      HandleScope chunk_scope(isolate);
+      size_t end = std::min(length, start + kArrayChunkLength);
+      for (size_t i = start; i < end; i++) {
+        if (!array->Set(context, static_cast<uint32_t>(i),
+                        V::New(isolate, data[i])).FromMaybe(false)) {
+          return Local<Array>();
+        }
+      }
+    }
+    return scope.Escape(array);
+  }
+
+  // Settles the promise of deferred and frees deferred.
+  static bool SettleDeferred(JSNIEnv* env,
+                             JSNIDeferred deferred,
+                             JSValueRef value,
+                             bool resolve) {
+    Isolate* isolate = JSNI::GetIsolate(env);
+    HandleScope scope(isolate);
+    Local<Context> context = isolate->GetCurrentContext();
+    Global<Promise::Resolver>* global =
+      reinterpret_cast<Global<Promise::Resolver>*>(deferred);
+    Local<Promise::Resolver> resolver =
+      Local<Promise::Resolver>::New(isolate, *global);
+    delete global;
+    Local<Value> v8_value = JSNI::ToV8LocalValue(value);
+    bool success = resolve ?
+      resolver->Resolve(context, v8_value).FromMaybe(false) :
+      resolver->Reject(context, v8_value).FromMaybe(false);
+    if (!success) {
+      JSNI::SetErrorCode(env, OBJERR);
+    }
+    return success;
+  }
+
+  static Local<String> SetString(Isolate* isolate) {
+    return String::NewFromOneByte(isolate,
+                                  reinterpret_cast<const uint8_t*>("set"),
+                                  NewStringType::kInternalized, 3)
+             .ToLocalChecked();
+  }
+
   static Local<Value> ToV8LocalValue(JSValueRef val) {
     return *reinterpret_cast<Local<Value>*>(&val);
   }
@@ -333,21 +1683,27 @@ class JSNI {
     JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
     return jsni_env_ext->isolate_;
   }
-
-  static JSNIEnv* GetEnv(Isolate* isolate) {
-    auto context = isolate->GetCurrentContext();
-    auto global = context->Global();
-    auto jsni_name = String::NewFromUtf8(
-                     isolate,
-                     "__jsni_env__", NewStringType::kNormal
-                     ).ToLocalChecked();
-    Local<External> jsni = global->Get(context, jsni_name).ToLocalChecked().As<External>();
-    JSNIEnv* env = reinterpret_cast<JSNIEnv*>(jsni->Value());
-    return env;
-  }
 };
 
 
+
+void JSNI::AsyncWorkPool::Run() {
+  for (;;) {
+    AsyncWork* work;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return !queue_.empty(); });
+      work = queue_.front();
+      queue_.pop_front();
+      running_.push_back(work);
+    }
+    work->Execute();
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_.erase(std::find(running_.begin(), running_.end(), work));
+    done_cv_.notify_all();
+  }
+}
+
 }  // namespace v8
 
 
@@ -355,9 +1711,21 @@ class JSNI {
   JSNI::ClearErrorCode(env);          \
   JSNI::JSNITryCatch try_catch(reinterpret_cast<JSNIEnvExt*>(env))
 
+// Prologue of the APIs which never call into JavaScript, e.g. type checks,
+// primitive constructors and callback info accessors. They can not throw,
+// so no TryCatch is needed. Building with JSNI_FAST_API also skips the error
+// code bookkeeping, and the last error survives these calls.
+#ifdef JSNI_FAST_API
+#define PREPARE_FAST_API_CALL(env)    \
+  (void)(env)
+#else
+#define PREPARE_FAST_API_CALL(env)    \
+  JSNI::ClearErrorCode(env)
+#endif
+
 int JSNIGetVersion(JSNIEnv* env) {
-  PREPARE_API_CALL(env);
-  return JSNI_VERSION_2_1;
+  PREPARE_FAST_API_CALL(env);
+  return JSNI_VERSION_2_4;
 }
 
 bool JSNIRegisterMethod(JSNIEnv* env, JSValueRef recv,
@@ -369,13 +1737,7 @@ bool JSNIRegisterMethod(JSNIEnv* env, JSValueRef recv,
   HandleScope handle_scope(isolate);
 
   // Create a fake function to keep opaque.
-  Local<FunctionTemplate> t =
-    FunctionTemplate::New(
-      isolate,
-      JSNI::FakeJSNICallback,
-      External::New(isolate, reinterpret_cast<void*>(callback)));
-
-  Local<Function> fn = t->GetFunction(ctx).ToLocalChecked();
+  Local<Function> fn = JSNI::NewFunction(env, callback);
   Local<String> fn_name = String::NewFromUtf8(isolate, name,
                                   NewStringType::kNormal).ToLocalChecked();
   fn->SetName(fn_name);
@@ -385,8 +1747,40 @@ bool JSNIRegisterMethod(JSNIEnv* env, JSValueRef recv,
           ->Set(ctx, fn_name, fn).FromJust();
 }
 
-int JSNIGetArgsLengthOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
+bool JSNIRegisterMethods(JSNIEnv* env, JSValueRef recv,
+                         const JSNIMethodDescriptor* methods,
+                         size_t count) {
   PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  Local<Context> ctx = isolate->GetCurrentContext();
+  HandleScope handle_scope(isolate);
+  Local<Object> obj = JSNI::ToV8LocalValue(recv)->ToObject(ctx)
+                        .ToLocalChecked();
+
+  bool result = true;
+  for (size_t i = 0; i < count; i++) {
+    // Bound the handles created by one method.
+    HandleScope method_scope(isolate);
+    Local<Function> fn = JSNI::NewFunction(env, methods[i].callback);
+    Local<String> fn_name =
+      String::NewFromUtf8(isolate, methods[i].name,
+                          NewStringType::kInternalized).ToLocalChecked();
+    fn->SetName(fn_name);
+    // Plain assignment is cheaper than a definition, so only go through
+    // DefineOwnProperty when attributes are requested.
+    Maybe<bool> success =
+      methods[i].attributes == JSNINone ?
+        obj->Set(ctx, fn_name, fn) :
+        obj->DefineOwnProperty(
+          ctx, fn_name, fn,
+          static_cast<PropertyAttribute>(methods[i].attributes));
+    result = success.FromMaybe(false) && result;
+  }
+  return result;
+}
+
+int JSNIGetArgsLengthOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
+  PREPARE_FAST_API_CALL(env);
   JSNI::JSNICallbackInfoWrap* jsni_info =
     reinterpret_cast<JSNI::JSNICallbackInfoWrap*>(info);
   JSNI::JSNICallbackInfoWrap::CallbackInfoType type = jsni_info->type();
@@ -395,6 +1789,8 @@ int JSNIGetArgsLengthOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
       return 0;
     case JSNI::JSNICallbackInfoWrap::kSetterProperty:
       return 1;
+    case JSNI::JSNICallbackInfoWrap::kInterceptor:
+      return jsni_info->value() != nullptr ? 1 : 0;
     case JSNI::JSNICallbackInfoWrap::kFunction:
     {
       const FunctionCallbackInfo<Value>* v8_info =
@@ -409,7 +1805,7 @@ int JSNIGetArgsLengthOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
 }
 
 JSValueRef JSNIGetArgOfCallback(JSNIEnv* env,  JSNICallbackInfo info, int id) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   JSNI::JSNICallbackInfoWrap* jsni_info =
     reinterpret_cast<JSNI::JSNICallbackInfoWrap*>(info);
   JSNI::JSNICallbackInfoWrap::CallbackInfoType type = jsni_info->type();
@@ -417,6 +1813,7 @@ JSValueRef JSNIGetArgOfCallback(JSNIEnv* env,  JSNICallbackInfo info, int id) {
     case JSNI::JSNICallbackInfoWrap::kGetterProperty:
       return NULL;
     case JSNI::JSNICallbackInfoWrap::kSetterProperty:
+    case JSNI::JSNICallbackInfoWrap::kInterceptor:
       if (id == 0) {
         return jsni_info->value();
       } else {
@@ -436,13 +1833,14 @@ JSValueRef JSNIGetArgOfCallback(JSNIEnv* env,  JSNICallbackInfo info, int id) {
 }
 
 JSValueRef JSNIGetThisOfCallback(JSNIEnv* env,  JSNICallbackInfo info) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   JSNI::JSNICallbackInfoWrap* jsni_info =
     reinterpret_cast<JSNI::JSNICallbackInfoWrap*>(info);
   JSNI::JSNICallbackInfoWrap::CallbackInfoType type = jsni_info->type();
   switch (type) {
     case JSNI::JSNICallbackInfoWrap::kGetterProperty:
     case JSNI::JSNICallbackInfoWrap::kSetterProperty:
+    case JSNI::JSNICallbackInfoWrap::kInterceptor:
     {
       const PropertyCallbackInfo<Value>* v8_info =
             reinterpret_cast<PropertyCallbackInfo<Value>*>(jsni_info->info());
@@ -463,7 +1861,7 @@ JSValueRef JSNIGetThisOfCallback(JSNIEnv* env,  JSNICallbackInfo info) {
 void JSNISetReturnValue(JSNIEnv* env,
                                   JSNICallbackInfo info,
                                   JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   JSNI::JSNICallbackInfoWrap* jsni_info =
     reinterpret_cast<JSNI::JSNICallbackInfoWrap*>(info);
   JSNI::JSNICallbackInfoWrap::CallbackInfoType type = jsni_info->type();
@@ -474,6 +1872,13 @@ void JSNISetReturnValue(JSNIEnv* env,
       JSNI::JSNIAbort("JSNISetReturnValueOfCallback",
                       "JSNISetReturnValueOfCallback can not"
                       "be called in setter property callback.");
+    case JSNI::JSNICallbackInfoWrap::kInterceptor:
+      // Checked by the interceptor before it is handed to V8.
+      if (jsni_info->result() != nullptr) {
+        *jsni_info->result() = v8_val;
+        break;
+      }
+      // Fall through.
     case JSNI::JSNICallbackInfoWrap::kGetterProperty:
     {
       const PropertyCallbackInfo<Value>* v8_info =
@@ -496,27 +1901,27 @@ void JSNISetReturnValue(JSNIEnv* env,
 
 // Primitive Operations
 bool JSNIIsUndefined(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsUndefined();
 }
 
 JSValueRef JSNINewUndefined(JSNIEnv* env) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return JSNI::RawNewUndefined(env);
 }
 
 bool JSNIIsNull(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsNull();
 }
 
 JSValueRef JSNINewNull(JSNIEnv* env) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return JSNI::ToJSNIValue(Null(JSNI::GetIsolate(env)));
 }
 
 bool JSNIIsBoolean(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsBoolean();
 }
 
@@ -533,18 +1938,18 @@ bool JSNIToCBool(JSNIEnv* env, JSValueRef val) {
 }
 
 JSValueRef JSNINewBoolean(JSNIEnv* env, bool val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
   return reinterpret_cast<JSValueRef>(*(Boolean::New(isolate, val)));
 }
 
 bool JSNIIsNumber(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsNumber();
 }
 
 JSValueRef JSNINewNumber(JSNIEnv* env, double val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
   return reinterpret_cast<JSValueRef>(*(Number::New(isolate, val)));
 }
@@ -601,7 +2006,7 @@ int64_t JSNIToInt64(JSNIEnv* env, JSValueRef val){
 }
 
 bool JSNIIsSymbol(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsSymbol();
 }
 
@@ -617,7 +2022,7 @@ JSValueRef JSNINewSymbol(JSNIEnv* env, JSValueRef name) {
 }
 
 bool JSNIIsString(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsString();
 }
 
@@ -695,14 +2100,173 @@ size_t JSNIGetString(JSNIEnv* env, JSValueRef string, uint16_t* copy, size_t len
   return result;
 }
 
+JSValueRef JSNINewStringFromLatin1(JSNIEnv* env, const char* src, size_t length) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  Local<String> str =
+      String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t*>(src),
+                             NewStringType::kNormal, length)
+          .ToLocalChecked();
+  return JSNI::ToJSNIValue(str);
+}
+
+size_t JSNIGetStringLatin1Chars(JSNIEnv* env,
+                                JSValueRef string,
+                                char* copy,
+                                size_t length) {
+  PREPARE_API_CALL(env);
+  assert(copy != nullptr);
+
+  if (!JSNI::ToV8LocalValue(string)->IsString()) {
+    JSNI::SetErrorCode(env, STRERR);
+    return 0;
+  }
+
+  String* s = reinterpret_cast<String*>(string);
+  return s->WriteOneByte(JSNI::GetIsolate(env),
+                         reinterpret_cast<uint8_t*>(copy), 0, length);
+}
+
+size_t JSNIWriteStringUtf8(JSNIEnv* env,
+                           JSValueRef string,
+                           char* buffer,
+                           size_t capacity) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::ToV8LocalValue(string)->IsString()) {
+    JSNI::SetErrorCode(env, STRERR);
+    return 0;
+  }
+
+  String* s = reinterpret_cast<String*>(string);
+  if (capacity > 0) {
+    assert(buffer != nullptr);
+    // Leave room for the null terminator.
+    int length = static_cast<int>(
+      std::min(capacity - 1,
+               static_cast<size_t>(std::numeric_limits<int>::max())));
+    int nchars = 0;
+    int written = s->WriteUtf8(JSNI::GetIsolate(env), buffer, length, &nchars,
+                               String::NO_NULL_TERMINATION |
+                               String::REPLACE_INVALID_UTF8);
+    if (nchars == s->Length()) {
+      buffer[written] = '\0';
+      return written;
+    }
+  }
+  // The buffer is too small, walk the string again for the full length.
+  return s->Utf8Length();
+}
+
+JSValueRef JSNINewExternalStringLatin1(JSNIEnv* env,
+                                       const char* data,
+                                       size_t length,
+                                       JSNIFinalizeCallback callback,
+                                       void* hint) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  JSNI::ExternalOneByteResource* resource =
+    new JSNI::ExternalOneByteResource(env, data, length, callback, hint);
+  Local<String> str;
+  if (!String::NewExternalOneByte(isolate, resource).ToLocal(&str)) {
+    // V8 does not take the ownership when the string is too long.
+    delete resource;
+    JSNI::SetErrorCode(env, RANERR);
+    return NULL;
+  }
+  isolate->AdjustAmountOfExternalAllocatedMemory(resource->ExternalSize());
+  return JSNI::ToJSNIValue(str);
+}
+
+JSValueRef JSNINewExternalString(JSNIEnv* env,
+                                 const uint16_t* data,
+                                 size_t length,
+                                 JSNIFinalizeCallback callback,
+                                 void* hint) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  JSNI::ExternalTwoByteResource* resource =
+    new JSNI::ExternalTwoByteResource(env, data, length, callback, hint);
+  Local<String> str;
+  if (!String::NewExternalTwoByte(isolate, resource).ToLocal(&str)) {
+    delete resource;
+    JSNI::SetErrorCode(env, RANERR);
+    return NULL;
+  }
+  isolate->AdjustAmountOfExternalAllocatedMemory(resource->ExternalSize());
+  return JSNI::ToJSNIValue(str);
+}
+
+bool JSNIGetStringView(JSNIEnv* env, JSValueRef string, JSNIStringView* view) {
+  PREPARE_API_CALL(env);
+  assert(view != nullptr);
+  view->encoding = JSNIOneByte;
+  view->data = nullptr;
+  view->length = 0;
+  view->reserved = nullptr;
+
+  if (!JSNI::ToV8LocalValue(string)->IsString()) {
+    JSNI::SetErrorCode(env, STRERR);
+    return false;
+  }
+
+  String* s = reinterpret_cast<String*>(string);
+  int length = s->Length();
+  view->length = length;
+
+  // External strings are flat and stable, read them in place.
+  String::Encoding encoding;
+  String::ExternalStringResourceBase* resource =
+    s->GetExternalStringResourceBase(&encoding);
+  if (resource != nullptr) {
+    if (encoding == String::ONE_BYTE_ENCODING) {
+      view->encoding = JSNIOneByte;
+      view->data =
+        static_cast<String::ExternalOneByteStringResource*>(resource)->data();
+    } else {
+      view->encoding = JSNITwoByte;
+      view->data =
+        static_cast<String::ExternalStringResource*>(resource)->data();
+    }
+    return true;
+  }
+
+  Isolate* isolate = JSNI::GetIsolate(env);
+  bool one_byte = s->IsOneByte();
+  size_t size = one_byte ? length : length * sizeof(uint16_t);
+  void* storage = view->storage;
+  if (size > sizeof(view->storage)) {
+    storage = malloc(size);
+    view->reserved = storage;
+  }
+  if (one_byte) {
+    view->encoding = JSNIOneByte;
+    s->WriteOneByte(isolate, static_cast<uint8_t*>(storage), 0, length,
+                    String::NO_NULL_TERMINATION);
+  } else {
+    view->encoding = JSNITwoByte;
+    s->Write(isolate, static_cast<uint16_t*>(storage), 0, length,
+             String::NO_NULL_TERMINATION);
+  }
+  view->data = storage;
+  return true;
+}
+
+void JSNIReleaseStringView(JSNIEnv* env, JSNIStringView* view) {
+  assert(view != nullptr);
+  free(view->reserved);
+  view->reserved = nullptr;
+  view->data = nullptr;
+  view->length = 0;
+}
+
 // Object Operations
 bool JSNIIsObject(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsObject();
 }
 
 bool JSNIIsEmpty(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return val == nullptr;
 }
 
@@ -800,6 +2364,138 @@ bool JSNIDeleteProperty(JSNIEnv* env, JSValueRef object, const char* name) {
   return t.FromJust();
 }
 
+JSNIPropertyKey JSNINewPropertyKey(JSNIEnv* env, const char* name) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  HandleScope scope(isolate);
+  Local<String> str = String::NewFromUtf8(isolate,
+                                          name,
+                                          NewStringType::kInternalized)
+                        .ToLocalChecked();
+  Persistent<Name>* key = new Persistent<Name>(isolate, str);
+  return reinterpret_cast<JSNIPropertyKey>(key);
+}
+
+void JSNIDeletePropertyKey(JSNIEnv* env, JSNIPropertyKey key) {
+  PREPARE_API_CALL(env);
+  Persistent<Name>* persistent = reinterpret_cast<Persistent<Name>*>(key);
+  if (persistent == nullptr) {
+    return;
+  }
+  persistent->Reset();
+  delete persistent;
+}
+
+bool JSNIHasPropertyByKey(JSNIEnv* env,
+                          JSValueRef object,
+                          JSNIPropertyKey key) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(object)->IsObject()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return false;
+  }
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Object> obj = JSNI::ToV8LocalValue(object).As<Object>();
+  return obj->Has(context, JSNI::ToV8Name(key)).FromMaybe(false);
+}
+
+JSValueRef JSNIGetPropertyByKey(JSNIEnv* env,
+                                JSValueRef object,
+                                JSNIPropertyKey key) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(object)->IsObject()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return JSNI::RawNewUndefined(env);
+  }
+  // The key and the object need no new handles, so the result is the only
+  // handle created here and no scope is needed.
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Object> obj = JSNI::ToV8LocalValue(object).As<Object>();
+  MaybeLocal<Value> p = obj->Get(context, JSNI::ToV8Name(key));
+  return JSNI::ToJSNIValue(p.FromMaybe(Local<Value>()));
+}
+
+bool JSNISetPropertyByKey(JSNIEnv* env,
+                          JSValueRef object,
+                          JSNIPropertyKey key,
+                          JSValueRef property) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(object)->IsObject()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return false;
+  }
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Object> obj = JSNI::ToV8LocalValue(object).As<Object>();
+  return obj->Set(context,
+                  JSNI::ToV8Name(key),
+                  JSNI::ToV8LocalValue(property)).FromMaybe(false);
+}
+
+bool JSNIDefinePropertyByKey(JSNIEnv* env,
+                             JSValueRef object,
+                             JSNIPropertyKey key,
+                             const JSNIPropertyDescriptor descriptor) {
+  return JSNI::DefineProperty(env, object, JSNI::ToV8Name(key), descriptor);
+}
+
+bool JSNIDefineProperties(JSNIEnv* env,
+                          JSValueRef object,
+                          const JSNINamedPropertyDescriptor* properties,
+                          size_t count) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  HandleScope handle_scope(isolate);
+  if (!JSNI::ToV8LocalValue(object)->IsObject()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return false;
+  }
+
+  bool result = true;
+  // Consecutive accessors of the same callbacks and data share a data object.
+  const JSNIAccessorPropertyDescriptor* last_accessor = nullptr;
+  Local<Value> wrap_data;
+  for (size_t i = 0; i < count; i++) {
+    const JSNIAccessorPropertyDescriptor* accessor =
+      properties[i].descriptor.accessor_attributes;
+    if (accessor != nullptr &&
+        (last_accessor == nullptr ||
+         accessor->getter != last_accessor->getter ||
+         accessor->setter != last_accessor->setter ||
+         accessor->data != last_accessor->data)) {
+      wrap_data = JSNI::WrapAccessorData(env, accessor->getter,
+                                         accessor->setter, accessor->data);
+      last_accessor = accessor;
+    }
+    // Bound the handles created by one property.
+    HandleScope property_scope(isolate);
+    Local<String> name =
+      String::NewFromUtf8(isolate, properties[i].name,
+                          NewStringType::kInternalized).ToLocalChecked();
+    result = JSNI::DefineProperty(env, object, name,
+                                  properties[i].descriptor,
+                                  accessor ? wrap_data : Local<Value>()) &&
+             result;
+  }
+  return result;
+}
+
+bool JSNIDeletePropertyByKey(JSNIEnv* env,
+                             JSValueRef object,
+                             JSNIPropertyKey key) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(object)->IsObject()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return false;
+  }
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Object> obj = JSNI::ToV8LocalValue(object).As<Object>();
+  return obj->Delete(context, JSNI::ToV8Name(key)).FromMaybe(false);
+}
+
 JSValueRef JSNIGetPrototype(JSNIEnv* env, JSValueRef object) {
   PREPARE_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
@@ -834,8 +2530,24 @@ void* JSNIGetInternalField(JSNIEnv* env, JSValueRef object, int index) {
   return field;
 }
 
+void JSNISetAlignedInternalField(JSNIEnv* env,
+                                 JSValueRef object,
+                                 int index,
+                                 void* field) {
+  PREPARE_FAST_API_CALL(env);
+  assert((reinterpret_cast<uintptr_t>(field) & 1) == 0);
+  Object::Cast(reinterpret_cast<Value*>(object))
+    ->SetAlignedPointerInInternalField(index, field);
+}
+
+void* JSNIGetAlignedInternalField(JSNIEnv* env, JSValueRef object, int index) {
+  PREPARE_FAST_API_CALL(env);
+  return Object::Cast(reinterpret_cast<Value*>(object))
+           ->GetAlignedPointerFromInternalField(index);
+}
+
 bool JSNIIsFunction(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
 return (reinterpret_cast<Value*>(val))->IsFunction();
 }
 
@@ -846,12 +2558,25 @@ JSValueRef JSNINewFunction(JSNIEnv* env, JSNICallback nativeFunc) {
   // the real function.
   Isolate* isolate = JSNI::GetIsolate(env);
   EscapableHandleScope scope(isolate);
+  Local<Function> function = JSNI::NewFunction(env, nativeFunc);
+  return reinterpret_cast<JSValueRef>(*(scope.Escape(function)));
+}
+
+JSValueRef JSNIGetFunction(JSNIEnv* env, JSNICallback nativeFunc) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  EscapableHandleScope scope(isolate);
   Local<Context> context = isolate->GetCurrentContext();
-  Local<FunctionTemplate> temp =
-    FunctionTemplate::New(
-      isolate,
-      JSNI::FakeJSNICallback,
-      External::New(isolate, reinterpret_cast<void*>(nativeFunc)));
+  JSNIFunctionCache& cache = JSNI::GetFunctionCache(env, nativeFunc);
+  Local<FunctionTemplate> temp;
+  if (cache.function_template.IsEmpty()) {
+    temp = FunctionTemplate::New(isolate, JSNI::FakeJSNICallback,
+                                 Local<Value>::New(isolate, cache.data));
+    cache.function_template.Reset(isolate, temp);
+  } else {
+    temp = Local<FunctionTemplate>::New(isolate, cache.function_template);
+  }
+  // The template instantiates the function once per context.
   Local<Function> function = temp->GetFunction(context).ToLocalChecked();
   return reinterpret_cast<JSValueRef>(*(scope.Escape(function)));
 }
@@ -879,7 +2604,7 @@ JSValueRef JSNICallFunction(JSNIEnv* env, JSValueRef func, JSValueRef recv,
 }
 
 bool JSNIIsArray(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsArray();
 }
 
@@ -898,10 +2623,38 @@ size_t JSNIGetArrayLength(JSNIEnv* env, JSValueRef array) {
 JSValueRef JSNINewArray(JSNIEnv* env, size_t initial_length) {
   PREPARE_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
-  Local<Array> v8_arr = Array::New(isolate);
+  if (initial_length > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    JSNI::SetErrorCode(env, RANERR);
+    return NULL;
+  }
+  Local<Array> v8_arr = Array::New(isolate, static_cast<int>(initial_length));
   return JSNI::ToJSNIValue(v8_arr);
 }
 
+JSValueRef JSNINewArrayFrom(JSNIEnv* env,
+                            const JSValueRef* elements,
+                            size_t length) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (length > static_cast<size_t>(std::numeric_limits<int>::max())) {
+    JSNI::SetErrorCode(env, RANERR);
+    return NULL;
+  }
+  EscapableHandleScope scope(isolate);
+  Local<Context> context = isolate->GetCurrentContext();
+  // Appending keeps the elements packed. A large pre-sized array starts
+  // with holey, or even dictionary, elements and is slower to fill.
+  Local<Array> v8_arr = Array::New(isolate, 0);
+  for (size_t i = 0; i < length; i++) {
+    Local<Value> val = JSNI::ToV8LocalValue(elements[i]);
+    if (!v8_arr->Set(context, static_cast<uint32_t>(i), val).FromMaybe(false)) {
+      JSNI::SetErrorCode(env, OBJERR);
+      return NULL;
+    }
+  }
+  return JSNI::ToJSNIValue(scope.Escape(v8_arr));
+}
+
 JSValueRef JSNIGetArrayElement(JSNIEnv* env, JSValueRef array, size_t index) {
   PREPARE_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
@@ -946,8 +2699,133 @@ void JSNISetArrayElement(JSNIEnv* env,
   }
 }
 
-bool JSNIIsTypedArray(JSNIEnv* env, JSValueRef val) {
+size_t JSNIGetArrayAsDoubles(JSNIEnv* env,
+                             JSValueRef array,
+                             double* out,
+                             size_t n) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::ToV8LocalValue(array)->IsArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return 0;
+  }
+  Local<Array> v8_arr = JSNI::ToV8LocalValue(array).As<Array>();
+  size_t count = std::min(n, static_cast<size_t>(v8_arr->Length()));
+  if (!JSNI::CopyArrayToNative(reinterpret_cast<JSNIEnvExt*>(env), v8_arr,
+                               JsArrayTypeFloat64, out, count)) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return 0;
+  }
+  return count;
+}
+
+size_t JSNIGetArrayAsInt32s(JSNIEnv* env,
+                            JSValueRef array,
+                            int32_t* out,
+                            size_t n) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::ToV8LocalValue(array)->IsArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return 0;
+  }
+  Local<Array> v8_arr = JSNI::ToV8LocalValue(array).As<Array>();
+  size_t count = std::min(n, static_cast<size_t>(v8_arr->Length()));
+  if (!JSNI::CopyArrayToNative(reinterpret_cast<JSNIEnvExt*>(env), v8_arr,
+                               JsArrayTypeInt32, out, count)) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return 0;
+  }
+  return count;
+}
+
+JSValueRef JSNINewArrayFromDoubles(JSNIEnv* env,
+                                   const double* data,
+                                   size_t length) {
+  PREPARE_API_CALL(env);
+  Local<Array> v8_arr =
+    JSNI::NewArrayFromNative<double, Number>(JSNI::GetIsolate(env),
+                                             data, length);
+  if (v8_arr.IsEmpty()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return NULL;
+  }
+  return JSNI::ToJSNIValue(v8_arr);
+}
+
+JSValueRef JSNINewArrayFromInt32s(JSNIEnv* env,
+                                  const int32_t* data,
+                                  size_t length) {
+  PREPARE_API_CALL(env);
+  Local<Array> v8_arr =
+    JSNI::NewArrayFromNative<int32_t, Integer>(JSNI::GetIsolate(env),
+                                               data, length);
+  if (v8_arr.IsEmpty()) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return NULL;
+  }
+  return JSNI::ToJSNIValue(v8_arr);
+}
+
+size_t JSNIGetArrayElements(JSNIEnv* env,
+                            JSValueRef array,
+                            size_t start,
+                            size_t count,
+                            JSValueRef* elements) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(array)->IsArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return 0;
+  }
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Array> v8_arr = JSNI::ToV8LocalValue(array).As<Array>();
+  size_t length = v8_arr->Length();
+  if (start >= length) {
+    return 0;
+  }
+  count = std::min(count, length - start);
+  // The values are created in the caller's scope, like the result of
+  // JSNIGetArrayElement.
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> val;
+    if (!v8_arr->Get(context, static_cast<uint32_t>(start + i)).ToLocal(&val)) {
+      JSNI::SetErrorCode(env, OBJERR);
+      return i;
+    }
+    elements[i] = JSNI::ToJSNIValue(val);
+  }
+  return count;
+}
+
+bool JSNISetArrayElements(JSNIEnv* env,
+                          JSValueRef array,
+                          size_t start,
+                          size_t count,
+                          const JSValueRef* elements) {
   PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(array)->IsArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return false;
+  }
+  if (start + count > UINT32_MAX || start + count < start) {
+    JSNI::SetErrorCode(env, RANERR);
+    return false;
+  }
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Array> v8_arr = JSNI::ToV8LocalValue(array).As<Array>();
+  for (size_t i = 0; i < count; i++) {
+    Local<Value> val = JSNI::ToV8LocalValue(elements[i]);
+    if (!v8_arr->Set(context, static_cast<uint32_t>(start + i), val)
+          .FromMaybe(false)) {
+      JSNI::SetErrorCode(env, OBJERR);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool JSNIIsTypedArray(JSNIEnv* env, JSValueRef val) {
+  PREPARE_FAST_API_CALL(env);
   return (reinterpret_cast<Value*>(val))->IsTypedArray();
 }
 
@@ -955,26 +2833,79 @@ JSValueRef JSNINewTypedArray(JSNIEnv* env,
                              JsTypedArrayType type,
                              void* data,
                              size_t length) {
-  // Only uint8 supported yet.
-  if (type != JsArrayTypeUint8) {
-    assert(0 && "Only uint8 supported yet.");
-  }
+  PREPARE_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
+  size_t element_size = JSNI::TypedArrayElementSize(type);
+  if (element_size == 0) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return NULL;
+  }
+  if (length > std::numeric_limits<size_t>::max() / element_size) {
+    JSNI::SetErrorCode(env, RANERR);
+    return NULL;
+  }
   EscapableHandleScope scope(isolate);
   Local<ArrayBuffer> abuf =
-    ArrayBuffer::New(isolate, data, length);
-  Local<Uint8Array> uarr = Uint8Array::New(abuf, 0, length);
-  return reinterpret_cast<JSValueRef>(*(scope.Escape(uarr)));
+    ArrayBuffer::New(isolate, data, length * element_size);
+  Local<TypedArray> array = JSNI::NewTypedArray(type, abuf, 0, length);
+  return reinterpret_cast<JSValueRef>(*(scope.Escape(array)));
+}
+
+JSValueRef JSNINewTypedArrayFromArrayBuffer(JSNIEnv* env,
+                                            JsTypedArrayType type,
+                                            JSValueRef array_buffer,
+                                            size_t byte_offset,
+                                            size_t length) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  if (!JSNI::ToV8LocalValue(array_buffer)->IsArrayBuffer()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return NULL;
+  }
+  size_t element_size = JSNI::TypedArrayElementSize(type);
+  if (element_size == 0) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return NULL;
+  }
+  Local<ArrayBuffer> abuf = JSNI::ToV8LocalValue(array_buffer).As<ArrayBuffer>();
+  size_t byte_length = abuf->ByteLength();
+  if (byte_offset % element_size != 0 ||
+      byte_offset > byte_length ||
+      length > (byte_length - byte_offset) / element_size) {
+    JSNI::SetErrorCode(env, RANERR);
+    return NULL;
+  }
+  EscapableHandleScope scope(isolate);
+  Local<TypedArray> array =
+    JSNI::NewTypedArray(type, abuf, byte_offset, length);
+  return reinterpret_cast<JSValueRef>(*(scope.Escape(array)));
 }
 
 JsTypedArrayType JSNIGetTypedArrayType(JSNIEnv* env, JSValueRef typed_array) {
   PREPARE_API_CALL(env);
-  if (!JSNI::ToV8LocalValue(typed_array)->IsTypedArray()) {
+  Local<Value> array = JSNI::ToV8LocalValue(typed_array);
+  if (!array->IsTypedArray()) {
     JSNI::SetErrorCode(env, ARRERR);
     return JsArrayTypeNone;
   }
-  if (TypedArray::Cast(reinterpret_cast<Value*>(typed_array))->IsUint8Array()) {
+  if (array->IsInt8Array()) {
+    return JsArrayTypeInt8;
+  } else if (array->IsUint8Array()) {
     return JsArrayTypeUint8;
+  } else if (array->IsUint8ClampedArray()) {
+    return JsArrayTypeUint8Clamped;
+  } else if (array->IsInt16Array()) {
+    return JsArrayTypeInt16;
+  } else if (array->IsUint16Array()) {
+    return JsArrayTypeUint16;
+  } else if (array->IsInt32Array()) {
+    return JsArrayTypeInt32;
+  } else if (array->IsUint32Array()) {
+    return JsArrayTypeUint32;
+  } else if (array->IsFloat32Array()) {
+    return JsArrayTypeFloat32;
+  } else if (array->IsFloat64Array()) {
+    return JsArrayTypeFloat64;
   }
   return JsArrayTypeNone;
 }
@@ -1003,13 +2934,46 @@ size_t JSNIGetTypedArrayLength(JSNIEnv* env, JSValueRef typed_array) {
   return array->Length();
 }
 
+size_t JSNIGetTypedArrayByteLength(JSNIEnv* env, JSValueRef typed_array) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::ToV8LocalValue(typed_array)->IsTypedArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return 0;
+  }
+  Local<TypedArray> array =
+    JSNI::ToV8LocalValue(typed_array).As<TypedArray>();
+  return array->ByteLength();
+}
+
+size_t JSNIGetTypedArrayByteOffset(JSNIEnv* env, JSValueRef typed_array) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::ToV8LocalValue(typed_array)->IsTypedArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return 0;
+  }
+  Local<TypedArray> array =
+    JSNI::ToV8LocalValue(typed_array).As<TypedArray>();
+  return array->ByteOffset();
+}
+
+JSValueRef JSNIGetTypedArrayBuffer(JSNIEnv* env, JSValueRef typed_array) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::ToV8LocalValue(typed_array)->IsTypedArray()) {
+    JSNI::SetErrorCode(env, ARRERR);
+    return NULL;
+  }
+  Isolate* isolate = JSNI::GetIsolate(env);
+  EscapableHandleScope scope(isolate);
+  Local<TypedArray> array =
+    JSNI::ToV8LocalValue(typed_array).As<TypedArray>();
+  return JSNI::ToJSNIValue(scope.Escape(array->Buffer()));
+}
+
 // Reference
 void JSNIPushLocalScope(JSNIEnv* env) {
   PREPARE_API_CALL(env);
-  Isolate* isolate = JSNI::GetIsolate(env);
-  JsLocalScope* local_scope = new JsLocalScope(isolate);
   JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
-  jsni_env_ext->stacked_local_scope.push_back(local_scope);
+  JSNI::PushLocalScope<JsLocalScope>(jsni_env_ext);
 }
 
 void JSNIPopLocalScope(JSNIEnv* env) {
@@ -1018,25 +2982,19 @@ void JSNIPopLocalScope(JSNIEnv* env) {
 
   // Set error code and return early
   // if the number of JSNIPopLocalScope used is more than JSNIPushLocalScope.
-  if (jsni_env_ext->stacked_local_scope.empty()) {
+  if (jsni_env_ext->local_scope_depth == 0) {
     JSNI::SetErrorCode(env, SCOERR);
     return;
   }
 
-  JsLocalScope* local_scope = reinterpret_cast<JsLocalScope*>(
-    jsni_env_ext->stacked_local_scope.back());
-  jsni_env_ext->stacked_local_scope.pop_back();
-
-  delete local_scope;
+  JSNI::PopLocalScope(jsni_env_ext);
 }
 
 // Reference
 void JSNIPushEscapableLocalScope(JSNIEnv* env) {
   PREPARE_API_CALL(env);
-  Isolate* isolate = JSNI::GetIsolate(env);
-  JsEscapableLocalScope* local_scope = new JsEscapableLocalScope(isolate);
   JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
-  jsni_env_ext->stacked_local_scope.push_back(local_scope);
+  JSNI::PushLocalScope<JsEscapableLocalScope>(jsni_env_ext);
 }
 
 JSValueRef JSNIPopEscapableLocalScope(JSNIEnv* env, JSValueRef val) {
@@ -1046,21 +3004,20 @@ JSValueRef JSNIPopEscapableLocalScope(JSNIEnv* env, JSValueRef val) {
 
   // Set error code and return early
   // if the number of JSNIPopLocalScope used is more than JSNIPushLocalScope.
-  if (jsni_env_ext->stacked_local_scope.empty()) {
+  if (jsni_env_ext->local_scope_depth == 0) {
     JSNI::SetErrorCode(env, SCOERR);
     return NULL;
   }
 
-  JsLocalScopeBase* scope_base = jsni_env_ext->stacked_local_scope.back();
+  JsLocalScopeBase* scope_base = JSNI::TopLocalScope(jsni_env_ext);
   CHECK(scope_base->IsEscapable());
   JsEscapableLocalScope* escapable_local_scope =
-    reinterpret_cast<JsEscapableLocalScope*>(scope_base);
-  jsni_env_ext->stacked_local_scope.pop_back();
+    static_cast<JsEscapableLocalScope*>(scope_base);
 
   Local<Value> escape =
     escapable_local_scope->Escape(JSNI::ToV8LocalValue(val));
   JSValueRef result = JSNI::ToJSNIValue(escape);
-  delete escapable_local_scope;
+  JSNI::PopLocalScope(jsni_env_ext);
 
   return result;
 }
@@ -1073,34 +3030,105 @@ JSGlobalValueRef JSNINewGlobalValue(JSNIEnv* env, JSValueRef val) {
 
 void JSNIDeleteGlobalValue(JSNIEnv* env, JSGlobalValueRef val) {
   PREPARE_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return;
+  }
   JSNI::JSRef::Delete(reinterpret_cast<JSNI::JSRef*>(val));
 }
 
 size_t JSNIAcquireGlobalValue(JSNIEnv* env, JSGlobalValueRef val) {
   PREPARE_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return 0;
+  }
   JSNI::JSRef* ref = reinterpret_cast<JSNI::JSRef*>(val);
   return ref->Ref();
 }
 
 size_t JSNIReleaseGlobalValue(JSNIEnv* env, JSGlobalValueRef val) {
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return 0;
+  }
   JSNI::JSRef* ref = reinterpret_cast<JSNI::JSRef*>(val);
   return ref->UnRef();
 }
 
 JSValueRef JSNIGetGlobalValue(JSNIEnv* env, JSGlobalValueRef val) {
   PREPARE_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return NULL;
+  }
   JSNI::JSRef* ref = reinterpret_cast<JSNI::JSRef*>(val);
   return ref->Get(env);
 }
 
+JSGlobalValueRef JSNINewWeakGlobalValue(JSNIEnv* env, JSValueRef val) {
+  PREPARE_API_CALL(env);
+  JSNI::JSRef* ref = JSNI::JSRef::New(env, val);
+  ref->MakeWeak();
+  return reinterpret_cast<JSGlobalValueRef>(ref);
+}
+
+bool JSNIMakeGlobalValueWeak(JSNIEnv* env, JSGlobalValueRef val) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return false;
+  }
+  JSNI::JSRef* ref = reinterpret_cast<JSNI::JSRef*>(val);
+  ref->MakeWeak();
+  return ref->IsAlive();
+}
+
+bool JSNIMakeGlobalValueStrong(JSNIEnv* env, JSGlobalValueRef val) {
+  PREPARE_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return false;
+  }
+  return reinterpret_cast<JSNI::JSRef*>(val)->MakeStrong();
+}
+
+bool JSNIIsGlobalValueAlive(JSNIEnv* env, JSGlobalValueRef val) {
+  PREPARE_FAST_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return false;
+  }
+  return reinterpret_cast<JSNI::JSRef*>(val)->IsAlive();
+}
+
 void JSNISetGCCallback(JSNIEnv* env,
                        JSGlobalValueRef global,
                        void* args,
                        JSNIGCCallback callback) {
+  if (!JSNI::JSRefSlab::IsLive(global)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return;
+  }
   JSNI::JSRef* ref = reinterpret_cast<JSNI::JSRef*>(global);
   ref->SetWeak(args, callback);
 }
 
+int64_t JSNIAdjustExternalMemory(JSNIEnv* env, int64_t change_in_bytes) {
+  PREPARE_FAST_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  return isolate->AdjustAmountOfExternalAllocatedMemory(change_in_bytes);
+}
+
+void JSNIAttachExternalMemory(JSNIEnv* env, JSGlobalValueRef val, size_t size) {
+  PREPARE_FAST_API_CALL(env);
+  if (!JSNI::JSRefSlab::IsLive(val)) {
+    JSNI::SetErrorCode(env, REFERR);
+    return;
+  }
+  reinterpret_cast<JSNI::JSRef*>(val)->AttachExternalMemory(size);
+}
+
 // Exception
 void JSNIThrowErrorException(JSNIEnv* env, const char* errmsg) {
   PREPARE_API_CALL(env);
@@ -1156,46 +3184,10 @@ bool JSNIDefineProperty(JSNIEnv* env,
                         const char* name,
                         const JSNIPropertyDescriptor descriptor) {
   Isolate* isolate = JSNI::GetIsolate(env);
-  Local<Context> context = isolate->GetCurrentContext();
-  JSNIDataPropertyDescriptor* data_attributes =
-    descriptor.data_attributes;
-  JSNIAccessorPropertyDescriptor* accessor_attributes =
-    descriptor.accessor_attributes;
-  Local<Object> obj = JSNI::ToV8LocalValue(object).As<Object>();
   Local<Name> pro_name = String::NewFromUtf8(isolate,
                                name,
                                NewStringType::kNormal).ToLocalChecked();
-
-  CHECK(data_attributes == NULL || accessor_attributes == NULL);
-  if (accessor_attributes != NULL) {
-    CHECK(data_attributes == NULL);
-    JSNICallback getter = accessor_attributes->getter;
-    JSNICallback setter = accessor_attributes->setter;
-
-    Local<Value> wrap_data =
-      JSNI::WrapAccessorData(env, getter, setter, accessor_attributes->data);
-
-    bool result = obj->SetAccessor(
-      context,
-      pro_name,
-      getter ? JSNI::WrapGetter : NULL,
-      setter ? JSNI::WrapSetter : NULL,
-      wrap_data,
-      AccessControl::DEFAULT,
-      static_cast<PropertyAttribute>(accessor_attributes->attributes))
-        .FromMaybe(false);
-    return result;
-  } else {
-    CHECK(accessor_attributes == NULL);
-    PropertyAttribute attributes =
-      static_cast<PropertyAttribute>(data_attributes->attributes);
-    bool result =
-      obj->DefineOwnProperty(context,
-                             pro_name,
-                             JSNI::ToV8LocalValue(data_attributes->value),
-                             attributes).FromMaybe(false);
-    return result;
-  }
+  return JSNI::DefineProperty(env, object, pro_name, descriptor);
 }
 
 void* JSNIGetDataOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
@@ -1209,6 +3201,7 @@ void* JSNIGetDataOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
                       "No data should be in function callback.");
     case JSNI::JSNICallbackInfoWrap::kSetterProperty:
     case JSNI::JSNICallbackInfoWrap::kGetterProperty:
+    case JSNI::JSNICallbackInfoWrap::kInterceptor:
       external =
         reinterpret_cast<PropertyCallbackInfo<Value>*>(
           jsni_info->info())
@@ -1222,6 +3215,13 @@ void* JSNIGetDataOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
   return NULL;
 }
 
+JSValueRef JSNIGetPropertyOfCallback(JSNIEnv* env, JSNICallbackInfo info) {
+  PREPARE_FAST_API_CALL(env);
+  JSNI::JSNICallbackInfoWrap* jsni_info =
+    reinterpret_cast<JSNI::JSNICallbackInfoWrap*>(info);
+  return jsni_info->property();
+}
+
 bool JSNIHasException(JSNIEnv* env) {
   JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
   return !jsni_env_ext->last_exception.IsEmpty();
@@ -1280,7 +3280,7 @@ void JSNIThrowErrorObject(JSNIEnv* env, JSValueRef error) {
 }
 
 bool JSNIIsError(JSNIEnv* env, JSValueRef val) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   Isolate* isolate = JSNI::GetIsolate(env);
   HandleScope scope(isolate);
   Local<Value> v8val = JSNI::ToV8LocalValue(val);
@@ -1314,7 +3314,7 @@ bool JSNIInstanceOf(JSNIEnv* env, JSValueRef left, JSValueRef right) {
 }
 
 JSValueRef JSNIGetNewTarget(JSNIEnv* env, JSNICallbackInfo info) {
-  PREPARE_API_CALL(env);
+  PREPARE_FAST_API_CALL(env);
   JSNI::JSNICallbackInfoWrap* jsni_info = reinterpret_cast<JSNI::JSNICallbackInfoWrap*>(info);
   JSNI::JSNICallbackInfoWrap::CallbackInfoType type = jsni_info->type();
   assert(type == JSNI::JSNICallbackInfoWrap::kFunction);
@@ -1323,8 +3323,41 @@ JSValueRef JSNIGetNewTarget(JSNIEnv* env, JSNICallbackInfo info) {
   return JSNI::ToJSNIValue(v8_info->NewTarget());
 }
 
-bool JSNIStrictEquals(JSNIEnv* env, JSValueRef left, JSValueRef right) {
+JSValueRef JSNIDefineClass(JSNIEnv* env,
+                           const JSNIClassDescriptor* descriptor) {
   PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  EscapableHandleScope scope(isolate);
+  Local<Context> context = isolate->GetCurrentContext();
+  JSNIEnvExt* jsni_env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+  if (descriptor->name == nullptr) {
+    JSNI::SetErrorCode(env, STRERR);
+    return NULL;
+  }
+  JSNIClassCache& cache = jsni_env_ext->class_templates[
+    reinterpret_cast<void*>(descriptor->constructor)];
+  std::string signature = JSNI::ClassSignature(descriptor);
+  Local<FunctionTemplate> temp;
+  if (cache.class_template.IsEmpty()) {
+    temp = JSNI::NewClassTemplate(env, descriptor);
+    cache.class_template.Reset(isolate, temp);
+    cache.signature.swap(signature);
+  } else if (cache.signature == signature) {
+    temp = Local<FunctionTemplate>::New(isolate, cache.class_template);
+  } else {
+    JSNI::SetErrorCode(env, CLSERR);
+    return NULL;
+  }
+  Local<Function> constructor;
+  if (!temp->GetFunction(context).ToLocal(&constructor)) {
+    JSNI::SetErrorCode(env, FUNCERR);
+    return NULL;
+  }
+  return JSNI::ToJSNIValue(scope.Escape(constructor));
+}
+
+bool JSNIStrictEquals(JSNIEnv* env, JSValueRef left, JSValueRef right) {
+  PREPARE_FAST_API_CALL(env);
   Local<Value> l = JSNI::ToV8LocalValue(left);
   Local<Value> r = JSNI::ToV8LocalValue(right);
   return l->StrictEquals(r);
@@ -1344,8 +3377,19 @@ JSValueRef JSNINewArrayBufferExternalized(JSNIEnv* env, void* data, size_t lengt
   return JSNI::ToJSNIValue(buffer);
 }
 
-bool JSNIIsArrayBuffer(JSNIEnv* env, JSValueRef val){
+JSValueRef JSNINewArrayBufferWithFinalizer(JSNIEnv* env,
+                                           void* data,
+                                           size_t length,
+                                           JSNIFinalizeCallback callback,
+                                           void* hint) {
   PREPARE_API_CALL(env);
+  Local<ArrayBuffer> buffer =
+    JSNI::ExternalArrayBuffer::New(env, data, length, callback, hint);
+  return JSNI::ToJSNIValue(buffer);
+}
+
+bool JSNIIsArrayBuffer(JSNIEnv* env, JSValueRef val){
+  PREPARE_FAST_API_CALL(env);
   Local<Value> value = JSNI::ToV8LocalValue(val);
   return value->IsArrayBuffer();
 }
@@ -1373,3 +3417,131 @@ JSValueRef JSNIGetPropertyNames(JSNIEnv* env, JSValueRef val) {
   MaybeLocal<Array> names = object->GetPropertyNames(context);
   return JSNI::ToJSNIValue(scope.Escape(names.ToLocalChecked()));
 }
+
+void JSNISetInstanceData(JSNIEnv* env,
+                         const void* key,
+                         void* data,
+                         JSNIFinalizeCallback finalize,
+                         void* hint) {
+  PREPARE_FAST_API_CALL(env);
+  JSNIEnvExt* env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+  env_ext->instance_data[key] = {data, finalize, hint};
+}
+
+void* JSNIGetInstanceData(JSNIEnv* env, const void* key) {
+  PREPARE_FAST_API_CALL(env);
+  JSNIEnvExt* env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+  auto it = env_ext->instance_data.find(key);
+  return it == env_ext->instance_data.end() ? nullptr : it->second.data;
+}
+
+void JSNIAddCleanupHook(JSNIEnv* env, JSNICleanupHook fun, void* arg) {
+  PREPARE_FAST_API_CALL(env);
+  JSNIEnvExt* env_ext = reinterpret_cast<JSNIEnvExt*>(env);
+  env_ext->cleanup_hooks.push_back({fun, arg});
+}
+
+void JSNIRemoveCleanupHook(JSNIEnv* env, JSNICleanupHook fun, void* arg) {
+  PREPARE_FAST_API_CALL(env);
+  std::vector<JSNICleanupHookEntry>& hooks =
+    reinterpret_cast<JSNIEnvExt*>(env)->cleanup_hooks;
+  for (auto it = hooks.rbegin(); it != hooks.rend(); ++it) {
+    if (it->fun == fun && it->arg == arg) {
+      hooks.erase(std::next(it).base());
+      return;
+    }
+  }
+}
+
+JSNIAsyncWork JSNINewAsyncWork(JSNIEnv* env,
+                               JSNIAsyncExecuteCallback execute,
+                               JSNIAsyncCompleteCallback complete,
+                               void* data) {
+  PREPARE_API_CALL(env);
+  assert(execute != nullptr);
+  return reinterpret_cast<JSNIAsyncWork>(
+    new JSNI::AsyncWork(env, execute, complete, data));
+}
+
+void JSNIDeleteAsyncWork(JSNIEnv* env, JSNIAsyncWork work) {
+  PREPARE_API_CALL(env);
+  delete reinterpret_cast<JSNI::AsyncWork*>(work);
+}
+
+bool JSNIQueueAsyncWork(JSNIEnv* env, JSNIAsyncWork work) {
+  PREPARE_API_CALL(env);
+  return reinterpret_cast<JSNI::AsyncWork*>(work)->Queue();
+}
+
+bool JSNICancelAsyncWork(JSNIEnv* env, JSNIAsyncWork work) {
+  PREPARE_API_CALL(env);
+  return reinterpret_cast<JSNI::AsyncWork*>(work)->Cancel();
+}
+
+bool JSNISetAsyncWorkPoolSize(JSNIEnv* env, size_t size) {
+  PREPARE_API_CALL(env);
+  return JSNI::AsyncWorkPool::Get()->SetSize(size);
+}
+
+JSValueRef JSNINewPromise(JSNIEnv* env, JSNIDeferred* deferred) {
+  PREPARE_API_CALL(env);
+  Isolate* isolate = JSNI::GetIsolate(env);
+  Local<Context> context = isolate->GetCurrentContext();
+  Local<Promise::Resolver> resolver;
+  if (!Promise::Resolver::New(context).ToLocal(&resolver)) {
+    JSNI::SetErrorCode(env, OBJERR);
+    return NULL;
+  }
+  *deferred = reinterpret_cast<JSNIDeferred>(
+    new Global<Promise::Resolver>(isolate, resolver));
+  return JSNI::ToJSNIValue(resolver->GetPromise());
+}
+
+bool JSNIResolveDeferred(JSNIEnv* env, JSNIDeferred deferred, JSValueRef value) {
+  PREPARE_API_CALL(env);
+  return JSNI::SettleDeferred(env, deferred, value, true);
+}
+
+bool JSNIRejectDeferred(JSNIEnv* env, JSNIDeferred deferred, JSValueRef reason) {
+  PREPARE_API_CALL(env);
+  return JSNI::SettleDeferred(env, deferred, reason, false);
+}
+
+bool JSNIIsPromise(JSNIEnv* env, JSValueRef val) {
+  PREPARE_FAST_API_CALL(env);
+  return JSNI::ToV8LocalValue(val)->IsPromise();
+}
+
+JSNIThreadSafeFunction JSNINewThreadSafeFunction(
+    JSNIEnv* env,
+    JSValueRef func,
+    size_t max_queue_size,
+    JSNIThreadSafeCallJSCallback call_js,
+    void* context,
+    JSNIFinalizeCallback finalize) {
+  PREPARE_API_CALL(env);
+  Local<Value> v8_func = JSNI::ToV8LocalValue(func);
+  if (!v8_func->IsFunction()) {
+    JSNI::SetErrorCode(env, FUNCERR);
+    return NULL;
+  }
+  return reinterpret_cast<JSNIThreadSafeFunction>(
+    new JSNI::ThreadSafeFunction(env, v8_func, max_queue_size,
+                                 call_js, context, finalize));
+}
+
+JSNIThreadSafeCallStatus JSNICallThreadSafeFunction(
+    JSNIThreadSafeFunction func,
+    void* data,
+    bool blocking) {
+  return reinterpret_cast<JSNI::ThreadSafeFunction*>(func)
+    ->Call(data, blocking);
+}
+
+bool JSNIAcquireThreadSafeFunction(JSNIThreadSafeFunction func) {
+  return reinterpret_cast<JSNI::ThreadSafeFunction*>(func)->Acquire();
+}
+
+void JSNIReleaseThreadSafeFunction(JSNIThreadSafeFunction func) {
+  reinterpret_cast<JSNI::ThreadSafeFunction*>(func)->Release();
+}
@@ -57,6 +57,64 @@ typedef struct _JSNIEnv JSNIEnv;
 */
 typedef void (*JSNIGCCallback)(JSNIEnv*, void*);
 
+/*! \typedef JSNIFinalizeCallback
+    \brief Finalize callback helper type, receives the finalized data and the hint.
+*/
+typedef void (*JSNIFinalizeCallback)(JSNIEnv*, void*, void*);
+
+/*! \typedef JSNIAsyncWork
+    \brief Native work run on a worker thread.
+*/
+typedef struct _JSNIAsyncWork* JSNIAsyncWork;
+
+/*! \enum JSNIAsyncStatus */
+typedef enum {
+  /*! The execute callback has run */
+  JSNIAsyncCompleted,
+  /*! The work was cancelled before it started */
+  JSNIAsyncCancelled
+} JSNIAsyncStatus;
+
+/*! \typedef JSNIAsyncExecuteCallback
+    \brief Runs on a worker thread, must not call JSNI functions.
+*/
+typedef void (*JSNIAsyncExecuteCallback)(void*);
+
+/*! \typedef JSNIAsyncCompleteCallback
+    \brief Runs on the loop thread once the work is done or cancelled.
+*/
+typedef void (*JSNIAsyncCompleteCallback)(JSNIEnv*, JSNIAsyncStatus, void*);
+
+/*! \typedef JSNIDeferred
+    \brief The pending settlement of a promise.
+*/
+typedef struct _JSNIDeferred* JSNIDeferred;
+
+/*! \typedef JSNIThreadSafeFunction
+    \brief A JavaScript function which native threads can call.
+*/
+typedef struct _JSNIThreadSafeFunction* JSNIThreadSafeFunction;
+
+/*! \enum JSNIThreadSafeCallStatus */
+typedef enum {
+  /*! The call is queued */
+  JSNIThreadSafeOK,
+  /*! The queue is full and the call is non-blocking */
+  JSNIThreadSafeQueueFull,
+  /*! The function is released */
+  JSNIThreadSafeClosing
+} JSNIThreadSafeCallStatus;
+
+/*! \typedef JSNIThreadSafeCallJSCallback
+    \brief Runs a queued call on the loop thread, receives the function, the context and the data of the call.
+*/
+typedef void (*JSNIThreadSafeCallJSCallback)(JSNIEnv*, JSValueRef, void*, void*);
+
+/*! \typedef JSNICleanupHook
+    \brief Cleanup hook helper type.
+*/
+typedef void (*JSNICleanupHook)(void*);
+
 /*! \typedef JSNICallbackInfo
     \brief Callback helper type.
 */
@@ -72,6 +130,11 @@ typedef void (*JSNICallback)(JSNIEnv*, const JSNICallbackInfo);
 */
 typedef struct _JSGlobalValueRef* JSGlobalValueRef;
 
+/*! \typedef JSNIPropertyKey
+    \brief Interned property name type.
+*/
+typedef struct _JSNIPropertyKey* JSNIPropertyKey;
+
 /*! \enum JsTypedArrayType
     \brief The type of a typed JavaScript array.
 */
@@ -140,6 +203,119 @@ typedef struct {
   JSNIAccessorPropertyDescriptor* accessor_attributes;
 } JSNIPropertyDescriptor;
 
+/*! \struct JSNINamedPropertyDescriptor */
+typedef struct {
+  /*! The property name */
+  const char* name;
+  /*! The property descriptor */
+  JSNIPropertyDescriptor descriptor;
+} JSNINamedPropertyDescriptor;
+
+/*! \struct JSNIMethodDescriptor */
+typedef struct {
+  /*! The method name */
+  const char* name;
+  /*! A native callback function */
+  JSNICallback callback;
+  /*! Property attributes of the method */
+  JSNIPropertyAttributes attributes;
+} JSNIMethodDescriptor;
+
+/*! \struct JSNIAccessorDescriptor */
+typedef struct {
+  /*! The property name */
+  const char* name;
+  /*! Accessor callback of getter */
+  JSNICallback getter;
+  /*! Accessor callback of setter, NULL for a read-only property */
+  JSNICallback setter;
+  /*! Property attributes */
+  JSNIPropertyAttributes attributes;
+  /*! The pointer of data passed to accessor getter and setter */
+  void* data;
+} JSNIAccessorDescriptor;
+
+/*! \struct JSNIInterceptorDescriptor
+    \brief Callbacks intercepting the property accesses of the instances of a class.
+    The property is given by JSNIGetPropertyOfCallback(), a string for a named interceptor
+    and a number for an indexed one. A callback which sets no return value lets the
+    access fall through to the object. A query, deleter or enumerator callback returning a
+    value of another type than documented throws a TypeError. Any of the callbacks can be NULL.
+*/
+typedef struct {
+  /*! Returns the value of the property */
+  JSNICallback getter;
+  /*! Receives the value as argument 0, returns any value to intercept the assignment */
+  JSNICallback setter;
+  /*! Returns the JSNIPropertyAttributes of the property as a number if it exists */
+  JSNICallback query;
+  /*! Returns true if the property is deleted, false if it can not be deleted */
+  JSNICallback deleter;
+  /*! Returns an array of the names or indices of the properties */
+  JSNICallback enumerator;
+  /*! The pointer of data passed to the callbacks */
+  void* data;
+} JSNIInterceptorDescriptor;
+
+/*! \struct JSNIClassDescriptor */
+typedef struct {
+  /*! The class name */
+  const char* name;
+  /*! The constructor callback, its receiver is the new instance */
+  JSNICallback constructor;
+  /*! The number of internal fields of every instance */
+  int internal_field_count;
+  /*! The methods on the prototype */
+  const JSNIMethodDescriptor* methods;
+  /*! The number of methods */
+  size_t method_count;
+  /*! The accessors on the prototype */
+  const JSNIAccessorDescriptor* accessors;
+  /*! The number of accessors */
+  size_t accessor_count;
+  /*! The accessors owned by every instance, still sharing one hidden class */
+  const JSNIAccessorDescriptor* instance_accessors;
+  /*! The number of instance accessors */
+  size_t instance_accessor_count;
+  /*! The interceptor of the string named properties of every instance, or NULL */
+  const JSNIInterceptorDescriptor* named_interceptor;
+  /*! The interceptor of the indexed properties of every instance, or NULL */
+  const JSNIInterceptorDescriptor* indexed_interceptor;
+} JSNIClassDescriptor;
+
+/*! \enum JSNIStringEncoding
+    \brief The encoding of the characters of a string view.
+*/
+typedef enum {
+  /*! Latin-1 characters, one byte each. */
+  JSNIOneByte,
+  /*! UTF-16 code units, two bytes each. */
+  JSNITwoByte
+} JSNIStringEncoding;
+
+/*! \def JSNI_STRING_VIEW_INLINE_SIZE
+    \brief The size in bytes of the storage embedded in JSNIStringView.
+*/
+#define JSNI_STRING_VIEW_INLINE_SIZE 128
+
+/*! \struct JSNIStringView
+    \brief A read-only view of the flattened characters of a string.
+    The view refers to its own storage for short strings, so it must not be
+    copied while in use.
+*/
+typedef struct {
+  /*! The encoding of data */
+  JSNIStringEncoding encoding;
+  /*! The characters, uint8_t for JSNIOneByte and uint16_t for JSNITwoByte */
+  const void* data;
+  /*! The number of characters */
+  size_t length;
+  /*! Internal: the heap storage owned by the view, or NULL */
+  void* reserved;
+  /*! Internal: the inline storage for short strings */
+  uint16_t storage[JSNI_STRING_VIEW_INLINE_SIZE / sizeof(uint16_t)];
+} JSNIStringView;
+
 /*! \enum JSNIErrorCode */
 typedef enum {
   /*! No error */
@@ -182,6 +358,18 @@ int JSNIGetVersion(JSNIEnv* env);
 */
 bool JSNIRegisterMethod(JSNIEnv* env, const JSValueRef recv, const char* name, JSNICallback callback);
 
+/*! \fn bool JSNIRegisterMethods(JSNIEnv* env, const JSValueRef recv, const JSNIMethodDescriptor* methods, size_t count)
+    \brief Registers a table of native callback functions in one pass.
+    \param env The JSNI environment pointer.
+    \param recv The method receiver. It is passed through JSNIInit to receive the
+registered JS functions associated with the callbacks.
+    \param methods An array of method descriptors.
+    \param count The number of method descriptors.
+    \return Returns true if all the methods are registered.
+    \since JSNI 2.4.
+*/
+bool JSNIRegisterMethods(JSNIEnv* env, const JSValueRef recv, const JSNIMethodDescriptor* methods, size_t count);
+
 /*! \fn int JSNIGetArgsLengthOfCallback(JSNIEnv* env, JSNICallbackInfo info)
     \brief Returns the number of arguments for the callback.
     \param env The JSNI environment pointer.
@@ -216,6 +404,16 @@ JSValueRef JSNIGetThisOfCallback(JSNIEnv* env, JSNICallbackInfo info);
 */
 void* JSNIGetDataOfCallback(JSNIEnv* env, JSNICallbackInfo info);
 
+/*! \fn JSValueRef JSNIGetPropertyOfCallback(JSNIEnv* env, JSNICallbackInfo info)
+    \brief Gets the property an accessor or interceptor callback is invoked for.
+    \param env The JSNI environment pointer.
+    \param info The callback info.
+    \return Returns the property name, or the index as a number in an indexed
+interceptor. Returns NULL in a function callback and in an enumerator.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNIGetPropertyOfCallback(JSNIEnv* env, JSNICallbackInfo info);
+
 /*! \fn void JSNISetReturnValue(JSNIEnv* env, JSNICallbackInfo info, JSValueRef val)
     \brief Sets the JavaScript return value for the callback.
     \param env The JSNI environment pointer.
@@ -417,6 +615,94 @@ size_t JSNIGetStringLength(JSNIEnv* env, JSValueRef string);
 */
 size_t JSNIGetString(JSNIEnv* env, JSValueRef string, uint16_t* copy, size_t length);
 
+/*! \fn JSValueRef JSNINewStringFromLatin1(JSNIEnv* env, const char* src, size_t length)
+    \brief Constructs a new String value from an array of characters in Latin-1 encoding.
+    \param env The JSNI environment pointer.
+    \param src The pointer to a Latin-1 string.
+    \param length The length of string to be created. It should exclude the null terminator.
+    If length equals -1, it will use the length of src.
+    \return Returns a String value, or NULL if the string can not be constructed.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewStringFromLatin1(JSNIEnv* env, const char* src, size_t length);
+
+/*! \fn size_t JSNIGetStringLatin1Chars(JSNIEnv* env, JSValueRef string, char* copy, size_t length)
+    \brief Copies a JavaScript string into a Latin-1 string buffer.
+    Characters above U+00FF are truncated to their low byte.
+    \param env The JSNI environment pointer.
+    \param string A JavaScript string value.
+    \param copy The buffer copied to.
+    \param length The number of characters to copy.
+    If length equals -1, it will copy the whole string and a null terminator.
+    \return Returns the number of characters copied, excluding the null terminator.
+    \since JSNI 2.4.
+*/
+size_t JSNIGetStringLatin1Chars(JSNIEnv* env, JSValueRef string, char* copy, size_t length);
+
+/*! \fn size_t JSNIWriteStringUtf8(JSNIEnv* env, JSValueRef string, char* buffer, size_t capacity)
+    \brief Writes a JavaScript string into a UTF-8 buffer and returns its UTF-8 length in a single call.
+    If the returned length is less than capacity, buffer holds the whole null-terminated string.
+    Otherwise the buffer is too small and should be retried with at least the returned length plus one,
+    so a stack buffer covers the common case without calling JSNIGetStringUtf8Length first.
+    \param env The JSNI environment pointer.
+    \param string A JavaScript string value.
+    \param buffer The buffer written to, can be NULL if capacity is 0.
+    \param capacity The size of buffer in bytes.
+    \return Returns the length in bytes of the UTF-8 representation of the string, excluding the null terminator.
+    \since JSNI 2.4.
+*/
+size_t JSNIWriteStringUtf8(JSNIEnv* env, JSValueRef string, char* buffer, size_t capacity);
+
+/*! \fn JSValueRef JSNINewExternalStringLatin1(JSNIEnv* env, const char* data, size_t length, JSNIFinalizeCallback callback, void* hint)
+    \brief Constructs a new String value backed by external Latin-1 characters.
+    The characters are not copied and must stay valid and unchanged until callback is invoked
+    with data and hint, once the string is garbage collected or the vm is disposed.
+    The callback must not call JSNI functions. When callback is not NULL, the characters
+    are reported to the vm as externally allocated memory until then.
+    \param env The JSNI environment pointer.
+    \param data The pointer to the Latin-1 characters.
+    \param length The number of characters.
+    \param callback The callback to release data, can be NULL.
+    \param hint The hint passed to the callback.
+    \return Returns a String value, or NULL if the string can not be constructed.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewExternalStringLatin1(JSNIEnv* env, const char* data, size_t length, JSNIFinalizeCallback callback, void* hint);
+
+/*! \fn JSValueRef JSNINewExternalString(JSNIEnv* env, const uint16_t* data, size_t length, JSNIFinalizeCallback callback, void* hint)
+    \brief Constructs a new String value backed by external two bytes characters.
+    The characters are not copied, see JSNINewExternalStringLatin1.
+    \param env The JSNI environment pointer.
+    \param data The pointer to the two bytes characters.
+    \param length The number of characters.
+    \param callback The callback to release data, can be NULL.
+    \param hint The hint passed to the callback.
+    \return Returns a String value, or NULL if the string can not be constructed.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewExternalString(JSNIEnv* env, const uint16_t* data, size_t length, JSNIFinalizeCallback callback, void* hint);
+
+/*! \fn bool JSNIGetStringView(JSNIEnv* env, JSValueRef string, JSNIStringView* view)
+    \brief Gets read access to the characters of a string in its own encoding.
+    The characters of an external string are accessed directly. Otherwise the flattened
+    string is copied once without transcoding, into the inline storage of the view when it fits.
+    The view must be released by JSNIReleaseStringView.
+    \param env The JSNI environment pointer.
+    \param string A JavaScript string value.
+    \param view The view to initialize.
+    \return Returns true if the view is initialized, false if string is not a String.
+    \since JSNI 2.4.
+*/
+bool JSNIGetStringView(JSNIEnv* env, JSValueRef string, JSNIStringView* view);
+
+/*! \fn void JSNIReleaseStringView(JSNIEnv* env, JSNIStringView* view)
+    \brief Releases the storage of a string view.
+    \param env The JSNI environment pointer.
+    \param view The view initialized by JSNIGetStringView.
+    \since JSNI 2.4.
+*/
+void JSNIReleaseStringView(JSNIEnv* env, JSNIStringView* view);
+
 /*! \fn bool JSNIIsObject(JSNIEnv* env, JSValueRef val)
     \brief Tests whether a JavaScript value is a JavaScript object.
     \param env The JSNI environment pointer.
@@ -470,7 +756,9 @@ bool JSNISetProperty(JSNIEnv* env, JSValueRef object, const char* name, JSValueR
 
 /*! \fn bool JSNIDefineProperty(JSNIEnv* env, JSValueRef object, const char* name, const JSNIPropertyDescriptor descriptor)
     \brief Defines a new property directly on an object, or modifies
-an existing property on an object.
+an existing property on an object. An accessor defined this way belongs to the
+object alone, so the accessors of wrapped native objects are better defined once
+with JSNIDefineClass().
     \param env The JSNI environment pointer.
     \param object The object on which to define the property.
     \param name The name of the property to be defined or modified.
@@ -488,6 +776,93 @@ bool JSNIDefineProperty(JSNIEnv* env, JSValueRef object, const char* name, const
 */
 bool JSNIDeleteProperty(JSNIEnv* env, JSValueRef object, const char* name);
 
+/*! \fn JSNIPropertyKey JSNINewPropertyKey(JSNIEnv* env, const char* name)
+    \brief Creates an interned property name which can be used with the
+keyed property operations. Creating the key once avoids constructing
+the name on every property access.
+The key must be disposed of by calling JSNIDeletePropertyKey().
+    \param env The JSNI environment pointer.
+    \param name A property name.
+    \return Returns a property key.
+    \since JSNI 2.4.
+*/
+JSNIPropertyKey JSNINewPropertyKey(JSNIEnv* env, const char* name);
+
+/*! \fn void JSNIDeletePropertyKey(JSNIEnv* env, JSNIPropertyKey key)
+    \brief Deletes the property key created by JSNINewPropertyKey().
+    \param env The JSNI environment pointer.
+    \param key A property key.
+    \return None.
+    \since JSNI 2.4.
+*/
+void JSNIDeletePropertyKey(JSNIEnv* env, JSNIPropertyKey key);
+
+/*! \fn bool JSNIHasPropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key)
+    \brief Tests whether a JavaScript object has a property named by key.
+    \param env The JSNI environment pointer.
+    \param object A JavaScript object.
+    \param key A property key.
+    \return Returns true if object has property named by key.
+    \since JSNI 2.4.
+*/
+bool JSNIHasPropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key);
+
+/*! \fn JSValueRef JSNIGetPropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key)
+    \brief Returns the property named by key of the JavaScript object.
+    \param env The JSNI environment pointer.
+    \param object A JavaScript object.
+    \param key A property key.
+    \return Returns the property of the JavaScript object.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNIGetPropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key);
+
+/*! \fn bool JSNISetPropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key, JSValueRef property)
+    \brief Sets a property named by key of a JavaScript object.
+    \param env The JSNI environment pointer.
+    \param object A JavaScript object.
+    \param key A property key.
+    \param property A JavaScript value.
+    \return Returns true if the operation succeeds.
+    \since JSNI 2.4.
+*/
+bool JSNISetPropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key, JSValueRef property);
+
+/*! \fn bool JSNIDefinePropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key, const JSNIPropertyDescriptor descriptor)
+    \brief Defines a new property named by key directly on an object,
+or modifies an existing property on an object.
+    \param env The JSNI environment pointer.
+    \param object The object on which to define the property.
+    \param key The key of the property to be defined or modified.
+    \param descriptor The descriptor for the property being defined or modified.
+    \return Returns true on success.
+    \since JSNI 2.4.
+*/
+bool JSNIDefinePropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key, const JSNIPropertyDescriptor descriptor);
+
+/*! \fn bool JSNIDefineProperties(JSNIEnv* env, JSValueRef object, const JSNINamedPropertyDescriptor* properties, size_t count)
+    \brief Defines a table of properties on an object in one pass, like calling
+JSNIDefineProperty() for each of them. Properties shared by many objects are better
+defined once on a class, see JSNIDefineClass().
+    \param env The JSNI environment pointer.
+    \param object The object on which to define the properties.
+    \param properties An array of named property descriptors.
+    \param count The number of properties.
+    \return Returns true if all the properties are defined.
+    \since JSNI 2.4.
+*/
+bool JSNIDefineProperties(JSNIEnv* env, JSValueRef object, const JSNINamedPropertyDescriptor* properties, size_t count);
+
+/*! \fn bool JSNIDeletePropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key)
+    \brief Deletes the property named by key of a JavaScript object.
+    \param env The JSNI environment pointer.
+    \param object A JavaScript object.
+    \param key A property key.
+    \return Returns true if the operation succeeds.
+    \since JSNI 2.4.
+*/
+bool JSNIDeletePropertyByKey(JSNIEnv* env, JSValueRef object, JSNIPropertyKey key);
+
 /*! \fn JSValueRef JSNIGetPrototype(JSNIEnv* env, JSValueRef object)
     \brief Returns a prototype of a JavaScript object.
     \param env The JSNI environment pointer.
@@ -533,6 +908,30 @@ void JSNISetInternalField(JSNIEnv* env, JSValueRef object, int index, void* fiel
 */
 void* JSNIGetInternalField(JSNIEnv* env, JSValueRef object, int index);
 
+/*! \fn void JSNISetAlignedInternalField(JSNIEnv* env, JSValueRef object, int index, void* field)
+    \brief Stores a pointer in an internal field of a JavaScript object without allocating,
+unlike JSNISetInternalField(). The pointer must be aligned to at least two bytes, which
+holds for pointers to objects allocated by malloc or new. A field set this way must be
+read with JSNIGetAlignedInternalField().
+    \param env The JSNI environment pointer.
+    \param object A JavaScript object.
+    \param index Index of an internal field.
+    \param field An aligned pointer. It will not be freed when object is garbage collected.
+    \since JSNI 2.4.
+*/
+void JSNISetAlignedInternalField(JSNIEnv* env, JSValueRef object, int index, void* field);
+
+/*! \fn void* JSNIGetAlignedInternalField(JSNIEnv* env, JSValueRef object, int index)
+    \brief Gets a pointer stored by JSNISetAlignedInternalField(). It does not create
+handles, so it is the fastest way for a wrapped method to find its native object.
+    \param env The JSNI environment pointer.
+    \param object A JavaScript object.
+    \param index Index of an internal field.
+    \return Returns the pointer.
+    \since JSNI 2.4.
+*/
+void* JSNIGetAlignedInternalField(JSNIEnv* env, JSValueRef object, int index);
+
 /*! \fn bool JSNIIsFunction(JSNIEnv* env, JSValueRef val)
     \brief Tests whether a JavaScript value is Function.
     \param env The JSNI environment pointer.
@@ -542,13 +941,25 @@ void* JSNIGetInternalField(JSNIEnv* env, JSValueRef object, int index);
 bool JSNIIsFunction(JSNIEnv* env, JSValueRef val);
 
 /*! \fn JSValueRef JSNINewFunction(JSNIEnv* env, JSNICallback callback)
-    \brief Constructs a JavaScript function with callback.
+    \brief Constructs a JavaScript function with callback. Every call returns
+a new function. Functions of the same callback share the native state.
     \param env The JSNI environment pointer.
     \param callback A native callback function.
     \return Returns a JavaScript function.
 */
 JSValueRef JSNINewFunction(JSNIEnv* env, JSNICallback callback);
 
+/*! \fn JSValueRef JSNIGetFunction(JSNIEnv* env, JSNICallback callback)
+    \brief Returns the JavaScript function of callback. Unlike JSNINewFunction(),
+the function is created once and the same function is returned on later calls
+in the same context.
+    \param env The JSNI environment pointer.
+    \param callback A native callback function.
+    \return Returns a JavaScript function.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNIGetFunction(JSNIEnv* env, JSNICallback callback);
+
 /*! \fn JSValueRef JSNICallFunction(JSNIEnv* env, JSValueRef func, JSValueRef recv, int argc, JSValueRef* argv)
     \brief Calls a JavaScript function.
     \param env The JSNI environment pointer.
@@ -578,12 +989,23 @@ size_t JSNIGetArrayLength(JSNIEnv* env, JSValueRef array);
 
 /*! \fn JSValueRef JSNINewArray(JSNIEnv* env, size_t initial_length)
     \brief Constructs a JavaScript array with initial length: initial_length.
+    The elements are holes until they are set.
     \param env The JSNI environment pointer.
     \param initial_length Initial array size.
     \return Returns a JavaScript array object, or NULL if the operation fails.
 */
 JSValueRef JSNINewArray(JSNIEnv* env, size_t initial_length);
 
+/*! \fn JSValueRef JSNINewArrayFrom(JSNIEnv* env, const JSValueRef* elements, size_t length)
+    \brief Constructs a JavaScript array holding the elements of a native array.
+    \param env The JSNI environment pointer.
+    \param elements The JavaScript values of the elements.
+    \param length The number of elements.
+    \return Returns a JavaScript array object, or NULL if the operation fails.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewArrayFrom(JSNIEnv* env, const JSValueRef* elements, size_t length);
+
 /*! \fn JSValueRef JSNIGetArrayElement(JSNIEnv* env, JSValueRef array, size_t index)
     \brief Returns an element of a JavaScript array.
     \param env The JSNI environment pointer.
@@ -603,6 +1025,78 @@ JSValueRef JSNIGetArrayElement(JSNIEnv* env, JSValueRef array, size_t index);
 */
 void JSNISetArrayElement(JSNIEnv* env, JSValueRef array, size_t index, JSValueRef value);
 
+/*! \fn size_t JSNIGetArrayElements(JSNIEnv* env, JSValueRef array, size_t start, size_t count, JSValueRef* elements)
+    \brief Reads a range of elements of a JavaScript array into a native array.
+    The values are created in the current local scope.
+    \param env The JSNI environment pointer.
+    \param array A JavaScript array.
+    \param start The index of the first element to read.
+    \param count The maximum number of elements to read.
+    \param elements The native array receiving the elements.
+    \return Returns the number of elements read, which is less than count when the range
+    extends past the end of the array.
+    \since JSNI 2.4.
+*/
+size_t JSNIGetArrayElements(JSNIEnv* env, JSValueRef array, size_t start, size_t count, JSValueRef* elements);
+
+/*! \fn bool JSNISetArrayElements(JSNIEnv* env, JSValueRef array, size_t start, size_t count, const JSValueRef* elements)
+    \brief Writes the elements of a native array into a range of a JavaScript array.
+    The JavaScript array grows if the range extends past its end.
+    \param env The JSNI environment pointer.
+    \param array A JavaScript array.
+    \param start The index of the first element to write.
+    \param count The number of elements to write.
+    \param elements The JavaScript values to write.
+    \return Returns true if all the elements are written.
+    \since JSNI 2.4.
+*/
+bool JSNISetArrayElements(JSNIEnv* env, JSValueRef array, size_t start, size_t count, const JSValueRef* elements);
+
+/*! \fn size_t JSNIGetArrayAsDoubles(JSNIEnv* env, JSValueRef array, double* out, size_t n)
+    \brief Copies the elements of a JavaScript array into a native double buffer.
+    Elements are converted like Float64Array.prototype.set does. Arrays of numbers
+    are copied in bulk by the vm when the whole array fits in out.
+    \param env The JSNI environment pointer.
+    \param array A JavaScript array.
+    \param out The buffer copied to.
+    \param n The number of elements out can hold.
+    \return Returns the number of elements copied.
+    \since JSNI 2.4.
+*/
+size_t JSNIGetArrayAsDoubles(JSNIEnv* env, JSValueRef array, double* out, size_t n);
+
+/*! \fn size_t JSNIGetArrayAsInt32s(JSNIEnv* env, JSValueRef array, int32_t* out, size_t n)
+    \brief Copies the elements of a JavaScript array into a native int32 buffer.
+    Elements are converted like Int32Array.prototype.set does, see JSNIGetArrayAsDoubles.
+    \param env The JSNI environment pointer.
+    \param array A JavaScript array.
+    \param out The buffer copied to.
+    \param n The number of elements out can hold.
+    \return Returns the number of elements copied.
+    \since JSNI 2.4.
+*/
+size_t JSNIGetArrayAsInt32s(JSNIEnv* env, JSValueRef array, int32_t* out, size_t n);
+
+/*! \fn JSValueRef JSNINewArrayFromDoubles(JSNIEnv* env, const double* data, size_t length)
+    \brief Constructs a JavaScript array of numbers from a native double buffer.
+    \param env The JSNI environment pointer.
+    \param data The numbers.
+    \param length The number of elements.
+    \return Returns a JavaScript array object, or NULL if the operation fails.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewArrayFromDoubles(JSNIEnv* env, const double* data, size_t length);
+
+/*! \fn JSValueRef JSNINewArrayFromInt32s(JSNIEnv* env, const int32_t* data, size_t length)
+    \brief Constructs a JavaScript array of numbers from a native int32 buffer.
+    \param env The JSNI environment pointer.
+    \param data The numbers.
+    \param length The number of elements.
+    \return Returns a JavaScript array object, or NULL if the operation fails.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewArrayFromInt32s(JSNIEnv* env, const int32_t* data, size_t length);
+
 /*! \fn bool JSNIIsTypedArray(JSNIEnv* env, JSValueRef val)
     \brief Tests whether a JavaScript value is TypedArray.
     \param env The JSNI environment pointer.
@@ -616,11 +1110,27 @@ bool JSNIIsTypedArray(JSNIEnv* env, JSValueRef val);
     \param env The JSNI environment pointer.
     \param type The type of the array.
     \param data The pointer to the data buffer of the array.
-    \param length The length of the array.
-    \return Returns a JavaScript TypedArray object.
+    \param length The number of elements of the array.
+    \return Returns a JavaScript TypedArray object, or NULL if the byte
+    length of the array overflows.
 */
 JSValueRef JSNINewTypedArray(JSNIEnv* env, JsTypedArrayType type, void* data, size_t length);
 
+/*! \fn JSValueRef JSNINewTypedArrayFromArrayBuffer(JSNIEnv* env, JsTypedArrayType type, JSValueRef array_buffer, size_t byte_offset, size_t length)
+    \brief Constructs a JavaScript TypedArray object which views the data of an existing
+ArrayBuffer. No data is copied.
+    \param env The JSNI environment pointer.
+    \param type The type of the array.
+    \param array_buffer A JavaScript ArrayBuffer.
+    \param byte_offset The offset in bytes of the view in the ArrayBuffer.
+    It should be a multiple of the element size.
+    \param length The number of elements of the array.
+    \return Returns a JavaScript TypedArray object, or NULL if the view
+    does not fit in the ArrayBuffer.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewTypedArrayFromArrayBuffer(JSNIEnv* env, JsTypedArrayType type, JSValueRef array_buffer, size_t byte_offset, size_t length);
+
 /*! \fn JsTypedArrayType JSNIGetTypedArrayType(JSNIEnv* env, JSValueRef typed_array)
     \brief Returns the type of the JavaScript TypedArray value.
     \param env The JSNI environment pointer.
@@ -645,6 +1155,33 @@ void* JSNIGetTypedArrayData(JSNIEnv* env, JSValueRef typed_array);
 */
 size_t JSNIGetTypedArrayLength(JSNIEnv* env, JSValueRef typed_array);
 
+/*! \fn size_t JSNIGetTypedArrayByteLength(JSNIEnv* env, JSValueRef typed_array)
+    \brief Returns the size in bytes of the TypedArray value.
+    \param env The JSNI environment pointer.
+    \param typed_array A JavaScript TypedArray value.
+    \return Returns the byte length of the TypedArray value.
+    \since JSNI 2.4.
+*/
+size_t JSNIGetTypedArrayByteLength(JSNIEnv* env, JSValueRef typed_array);
+
+/*! \fn size_t JSNIGetTypedArrayByteOffset(JSNIEnv* env, JSValueRef typed_array)
+    \brief Returns the offset in bytes of the TypedArray value in its ArrayBuffer.
+    \param env The JSNI environment pointer.
+    \param typed_array A JavaScript TypedArray value.
+    \return Returns the byte offset of the TypedArray value.
+    \since JSNI 2.4.
+*/
+size_t JSNIGetTypedArrayByteOffset(JSNIEnv* env, JSValueRef typed_array);
+
+/*! \fn JSValueRef JSNIGetTypedArrayBuffer(JSNIEnv* env, JSValueRef typed_array)
+    \brief Returns the ArrayBuffer viewed by the TypedArray value.
+    \param env The JSNI environment pointer.
+    \param typed_array A JavaScript TypedArray value.
+    \return Returns a JavaScript ArrayBuffer.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNIGetTypedArrayBuffer(JSNIEnv* env, JSValueRef typed_array);
+
 /*! \fn void JSNIPushLocalScope(JSNIEnv* env)
     \brief Creates a local reference scope, and then all local references will
 be allocated within this reference scope until the reference scope
@@ -697,7 +1234,11 @@ dispose it when decrease the reference count to zero.
 JSGlobalValueRef JSNINewGlobalValue(JSNIEnv* env, JSValueRef val);
 
 /*! \fn void JSNIDeleteGlobalValue(JSNIEnv* env, JSGlobalValueRef val)
-    \brief Deletes the global reference pointed by val.
+    \brief Deletes the global reference pointed by val. Using a deleted global
+value sets an error instead of corrupting memory, as long as its storage has not
+been reused by a new global value. The check is best-effort only: once the storage
+is reused, the deleted value refers to the new global value, so it must not be used
+after deletion.
     \param env The JSNI environment pointer.
     \param val A JSGlobalValueRef value.
     \return None.
@@ -734,6 +1275,47 @@ size_t JSNIReleaseGlobalValue(JSNIEnv* env, JSGlobalValueRef val);
 */
 JSValueRef JSNIGetGlobalValue(JSNIEnv* env, JSGlobalValueRef val);
 
+/*! \fn JSGlobalValueRef JSNINewWeakGlobalValue(JSNIEnv* env, JSValueRef val)
+    \brief Creates a new weak global reference to the JavaScript value referred to by
+the val argument. A weak global value does not keep the JavaScript value alive, and is
+emptied once the value is collected, so native caches keyed on JavaScript objects need
+no GC callback per entry. It must still be disposed of by calling JSNIDeleteGlobalValue().
+    \param env The JSNI environment pointer.
+    \param val A JavaScript value.
+    \return Returns a weak global value.
+    \since JSNI 2.4.
+*/
+JSGlobalValueRef JSNINewWeakGlobalValue(JSNIEnv* env, JSValueRef val);
+
+/*! \fn bool JSNIMakeGlobalValueWeak(JSNIEnv* env, JSGlobalValueRef val)
+    \brief Turns val into a weak global value, see JSNINewWeakGlobalValue().
+    \param env The JSNI environment pointer.
+    \param val A JSGlobalValueRef value.
+    \return Returns true if the JavaScript value is still alive.
+    \since JSNI 2.4.
+*/
+bool JSNIMakeGlobalValueWeak(JSNIEnv* env, JSGlobalValueRef val);
+
+/*! \fn bool JSNIMakeGlobalValueStrong(JSNIEnv* env, JSGlobalValueRef val)
+    \brief Turns the weak global value val back into a strong one that keeps the
+JavaScript value alive.
+    \param env The JSNI environment pointer.
+    \param val A JSGlobalValueRef value.
+    \return Returns false if the JavaScript value has already been collected.
+    \since JSNI 2.4.
+*/
+bool JSNIMakeGlobalValueStrong(JSNIEnv* env, JSGlobalValueRef val);
+
+/*! \fn bool JSNIIsGlobalValueAlive(JSNIEnv* env, JSGlobalValueRef val)
+    \brief Checks whether the JavaScript value of a global value has not been collected.
+Only weak global values can be emptied, JSNIGetGlobalValue() returns NULL for them then.
+    \param env The JSNI environment pointer.
+    \param val A JSGlobalValueRef value.
+    \return Returns true if the JavaScript value is alive.
+    \since JSNI 2.4.
+*/
+bool JSNIIsGlobalValueAlive(JSNIEnv* env, JSGlobalValueRef val);
+
 /*! \fn void JSNISetGCCallback(JSNIEnv* env, JSGlobalValueRef val, void* args, JSNIGCCallback callback)
     \brief Sets a callback which will be called when the JavaScript value pointed by val is freed.
 The developer can pass an argument to callback by args. JSNISetGCCallback() is only valid when reference count
@@ -746,6 +1328,29 @@ is bigger than zero.
 */
 void JSNISetGCCallback(JSNIEnv* env, JSGlobalValueRef val, void* args, JSNIGCCallback callback);
 
+/*! \fn int64_t JSNIAdjustExternalMemory(JSNIEnv* env, int64_t change_in_bytes)
+    \brief Reports native memory kept alive by JavaScript objects, e.g. by objects
+wrapping native data with JSNISetInternalField(), so that the vm schedules garbage
+collections in proportion to it. Every increase must be matched by a decrease once
+the memory is released.
+    \param env The JSNI environment pointer.
+    \param change_in_bytes The change of the externally allocated memory.
+    \return Returns the externally allocated memory the vm accounts for.
+    \since JSNI 2.4.
+*/
+int64_t JSNIAdjustExternalMemory(JSNIEnv* env, int64_t change_in_bytes);
+
+/*! \fn void JSNIAttachExternalMemory(JSNIEnv* env, JSGlobalValueRef val, size_t size)
+    \brief Reports size bytes of native memory owned by the JavaScript value of val, as
+JSNIAdjustExternalMemory() does. The memory is released from the accounting when val is
+deleted, or when its value is garbage collected if val has a GC callback.
+    \param env The JSNI environment pointer.
+    \param val A JSGlobalValueRef value.
+    \param size The size of the native memory.
+    \since JSNI 2.4.
+*/
+void JSNIAttachExternalMemory(JSNIEnv* env, JSGlobalValueRef val, size_t size);
+
 /*! \fn void JSNIThrowErrorException(JSNIEnv* env, const char* errmsg)
     \brief Constructs an error object with the message specified by errmsg
 and causes that error to be thrown. It throws a JavaScript Exception.
@@ -874,6 +1479,27 @@ bool JSNIInstanceOf(JSNIEnv* env, JSValueRef left, JSValueRef right);
 */
 JSValueRef JSNIGetNewTarget(JSNIEnv* env, JSNICallbackInfo info);
 
+/*! \fn JSValueRef JSNIDefineClass(JSNIEnv* env, const JSNIClassDescriptor* descriptor)
+    \brief Defines a class implemented by native callbacks and returns its constructor.
+The class is built once and cached in the env, keyed on the constructor callback, so
+defining it again in the same context returns the same constructor. Defining it again
+with a descriptor of other contents fails. All instances have
+the internal fields of the class and share their hidden class, and the methods and
+accessors live on the shared prototype. Instance accessors are own properties of every
+instance, e.g. to be listed by Object.keys, but are defined once on the instance template,
+so unlike JSNIDefineProperty() on every instance they do not give each instance its own
+hidden class. Interceptors produce the properties of instances lazily, e.g. from a large
+native table, instead of defining every property up front. Calling the constructor without new throws a
+TypeError, and calling a method or accessor on an object which is not an instance of
+the class throws a TypeError before the callback runs.
+    \param env The JSNI environment pointer.
+    \param descriptor The class descriptor.
+    \return Returns the constructor, to be used with JSNINewInstance(), or NULL if the
+    name is NULL or the class is already defined by another descriptor.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNIDefineClass(JSNIEnv* env, const JSNIClassDescriptor* descriptor);
+
 /*! \fn bool JSNIStrictEquals(JSNIEnv* env, JSValueRef left, JSValueRef right)
     \brief Tests whether the left JavaScript value is strict-equal to the right JavaScript value.
     \param env The JSNI environment pointer.
@@ -903,6 +1529,21 @@ JSValueRef JSNINewArrayBuffer(JSNIEnv* env, size_t length);
 */
 JSValueRef JSNINewArrayBufferExternalized(JSNIEnv* env, void* data, size_t length);
 
+/*! \fn JSValueRef JSNINewArrayBufferWithFinalizer(JSNIEnv* env, void* data, size_t length, JSNIFinalizeCallback callback, void* hint)
+    \brief Constructs a JavaScript ArrayBuffer which takes the ownership of the externalized data.
+    The data is not copied. When the ArrayBuffer is garbage collected, callback is invoked
+    with data and hint to release the data. The length is reported to the vm as
+    externally allocated memory while the ArrayBuffer is alive.
+    \param env The JSNI environment pointer.
+    \param data The externalized data.
+    \param length The ArrayBuffer length.
+    \param callback The callback to release the data, can be NULL.
+    \param hint The hint passed to the callback.
+    \return Returns a JavaScript ArrayBuffer with an externalized data.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewArrayBufferWithFinalizer(JSNIEnv* env, void* data, size_t length, JSNIFinalizeCallback callback, void* hint);
+
 /*! \fn bool JSNIIsArrayBuffer(JSNIEnv* env, JSValueRef val)
     \brief Tests whether a JavaScript value is ArrayBuffer.
     \param env The JSNI environment pointer.
@@ -939,6 +1580,187 @@ size_t JSNIGetArrayBufferLength(JSNIEnv* env, JSValueRef val);
 */
 JSValueRef JSNIGetPropertyNames(JSNIEnv* env, JSValueRef val);
 
+/*! \fn void JSNISetInstanceData(JSNIEnv* env, const void* key, void* data, JSNIFinalizeCallback finalize, void* hint)
+    \brief Associates the data of a native module with the JSNI environment.
+    Every worker thread and context loading the module has its own environment, so the
+    data replaces process wide statics. The finalize callback is invoked with data and
+    hint when the environment is deleted, and must not call into JavaScript.
+    Replacing the data does not finalize the previous one.
+    \param env The JSNI environment pointer.
+    \param key A key unique to the module, e.g. the address of a static variable of the module.
+    \param data The data.
+    \param finalize The callback to release the data, can be NULL.
+    \param hint The hint passed to the callback.
+    \since JSNI 2.4.
+*/
+void JSNISetInstanceData(JSNIEnv* env, const void* key, void* data, JSNIFinalizeCallback finalize, void* hint);
+
+/*! \fn void* JSNIGetInstanceData(JSNIEnv* env, const void* key)
+    \brief Returns the data of a native module set by JSNISetInstanceData.
+    \param env The JSNI environment pointer.
+    \param key The key of the module.
+    \return Returns the data, or NULL if no data is set.
+    \since JSNI 2.4.
+*/
+void* JSNIGetInstanceData(JSNIEnv* env, const void* key);
+
+/*! \fn void JSNIAddCleanupHook(JSNIEnv* env, JSNICleanupHook fun, void* arg)
+    \brief Registers a hook run when the JSNI environment is deleted, i.e. when its context
+    is collected or its thread shuts down. Hooks run in reverse order of registration, before
+    the instance data is finalized, and must not call into JavaScript.
+    \param env The JSNI environment pointer.
+    \param fun The hook.
+    \param arg The argument passed to the hook.
+    \since JSNI 2.4.
+*/
+void JSNIAddCleanupHook(JSNIEnv* env, JSNICleanupHook fun, void* arg);
+
+/*! \fn void JSNIRemoveCleanupHook(JSNIEnv* env, JSNICleanupHook fun, void* arg)
+    \brief Unregisters a hook registered by JSNIAddCleanupHook with the same argument.
+    \param env The JSNI environment pointer.
+    \param fun The hook.
+    \param arg The argument passed to the hook.
+    \since JSNI 2.4.
+*/
+void JSNIRemoveCleanupHook(JSNIEnv* env, JSNICleanupHook fun, void* arg);
+
+/*! \fn JSNIAsyncWork JSNINewAsyncWork(JSNIEnv* env, JSNIAsyncExecuteCallback execute, JSNIAsyncCompleteCallback complete, void* data)
+    \brief Creates a work to run execute on a worker thread, then complete on the loop thread.
+    \param env The JSNI environment pointer.
+    \param execute The callback run on a worker thread.
+    \param complete The callback run on the loop thread, can be NULL.
+    \param data The pointer of data passed to execute and complete.
+    \return Returns the async work.
+    \since JSNI 2.4.
+*/
+JSNIAsyncWork JSNINewAsyncWork(JSNIEnv* env, JSNIAsyncExecuteCallback execute, JSNIAsyncCompleteCallback complete, void* data);
+
+/*! \fn void JSNIDeleteAsyncWork(JSNIEnv* env, JSNIAsyncWork work)
+    \brief Deletes an async work. A queued work must be deleted in or after its complete callback.
+    \param env The JSNI environment pointer.
+    \param work The async work.
+    \since JSNI 2.4.
+*/
+void JSNIDeleteAsyncWork(JSNIEnv* env, JSNIAsyncWork work);
+
+/*! \fn bool JSNIQueueAsyncWork(JSNIEnv* env, JSNIAsyncWork work)
+    \brief Queues an async work to the worker pool.
+    The loop is kept alive until the complete callback runs. A work can be queued again once completed.
+    If the env is torn down first, e.g. when a worker thread exits, a work not started yet is
+    dropped and a running one is waited for, and the complete callback is not invoked.
+    \param env The JSNI environment pointer.
+    \param work The async work.
+    \return Returns false if the work is already queued.
+    \since JSNI 2.4.
+*/
+bool JSNIQueueAsyncWork(JSNIEnv* env, JSNIAsyncWork work);
+
+/*! \fn bool JSNICancelAsyncWork(JSNIEnv* env, JSNIAsyncWork work)
+    \brief Cancels a queued async work which has not started yet.
+    Its complete callback is invoked with JSNIAsyncCancelled.
+    \param env The JSNI environment pointer.
+    \param work The async work.
+    \return Returns true if the work is cancelled, false if it is running, done or not queued.
+    \since JSNI 2.4.
+*/
+bool JSNICancelAsyncWork(JSNIEnv* env, JSNIAsyncWork work);
+
+/*! \fn bool JSNISetAsyncWorkPoolSize(JSNIEnv* env, size_t size)
+    \brief Sets the number of worker threads. The pool is shared by the process and defaults
+    to the number of processors.
+    \param env The JSNI environment pointer.
+    \param size The number of worker threads.
+    \return Returns false if size is 0 or the pool has started, i.e. some work was queued.
+    \since JSNI 2.4.
+*/
+bool JSNISetAsyncWorkPoolSize(JSNIEnv* env, size_t size);
+
+/*! \fn JSValueRef JSNINewPromise(JSNIEnv* env, JSNIDeferred* deferred)
+    \brief Constructs a pending JavaScript promise.
+    \param env The JSNI environment pointer.
+    \param deferred Receives the deferred which settles the promise. It is freed by
+    JSNIResolveDeferred or JSNIRejectDeferred, exactly one of which must be called.
+    \return Returns a JavaScript promise, or NULL if the operation fails.
+    \since JSNI 2.4.
+*/
+JSValueRef JSNINewPromise(JSNIEnv* env, JSNIDeferred* deferred);
+
+/*! \fn bool JSNIResolveDeferred(JSNIEnv* env, JSNIDeferred deferred, JSValueRef value)
+    \brief Resolves the promise of a deferred and frees the deferred.
+    \param env The JSNI environment pointer.
+    \param deferred The deferred.
+    \param value The resolution value.
+    \return Returns true if the operation succeeds.
+    \since JSNI 2.4.
+*/
+bool JSNIResolveDeferred(JSNIEnv* env, JSNIDeferred deferred, JSValueRef value);
+
+/*! \fn bool JSNIRejectDeferred(JSNIEnv* env, JSNIDeferred deferred, JSValueRef reason)
+    \brief Rejects the promise of a deferred and frees the deferred.
+    \param env The JSNI environment pointer.
+    \param deferred The deferred.
+    \param reason The rejection reason.
+    \return Returns true if the operation succeeds.
+    \since JSNI 2.4.
+*/
+bool JSNIRejectDeferred(JSNIEnv* env, JSNIDeferred deferred, JSValueRef reason);
+
+/*! \fn bool JSNIIsPromise(JSNIEnv* env, JSValueRef val)
+    \brief Tests whether a JavaScript value is Promise.
+    \param env The JSNI environment pointer.
+    \param val A JavaScript value.
+    \return Returns true if val is Promise.
+    \since JSNI 2.4.
+*/
+bool JSNIIsPromise(JSNIEnv* env, JSValueRef val);
+
+/*! \fn JSNIThreadSafeFunction JSNINewThreadSafeFunction(JSNIEnv* env, JSValueRef func, size_t max_queue_size, JSNIThreadSafeCallJSCallback call_js, void* context, JSNIFinalizeCallback finalize)
+    \brief Creates a function which any thread can call through JSNICallThreadSafeFunction.
+    Calls are queued without locking and dispatched on the loop thread, all the calls queued by
+    the time the loop wakes up are dispatched together. The creating thread holds the first reference.
+    \param env The JSNI environment pointer.
+    \param func The JavaScript function.
+    \param max_queue_size The maximum number of queued calls, 0 for unlimited.
+    \param call_js The callback dispatching a call, or NULL to call func without arguments.
+    \param context The pointer of data passed to call_js and finalize.
+    \param finalize The callback invoked with context and a NULL hint on the loop thread
+    once all the references are released and the queued calls are dispatched, can be NULL.
+    If the env is torn down first, e.g. when a worker thread exits, queued calls are dropped and
+    finalize is invoked then, when JavaScript can no longer be called. Other threads must stop
+    using the function once it is finalized.
+    \return Returns the thread-safe function.
+    \since JSNI 2.4.
+*/
+JSNIThreadSafeFunction JSNINewThreadSafeFunction(JSNIEnv* env, JSValueRef func, size_t max_queue_size, JSNIThreadSafeCallJSCallback call_js, void* context, JSNIFinalizeCallback finalize);
+
+/*! \fn JSNIThreadSafeCallStatus JSNICallThreadSafeFunction(JSNIThreadSafeFunction func, void* data, bool blocking)
+    \brief Queues a call to a thread-safe function. Can be called from any thread holding a reference.
+    \param func The thread-safe function.
+    \param data The pointer of data passed to call_js.
+    \param blocking Whether to wait for room when the queue is full.
+    Blocking calls on the loop thread would dead lock.
+    \return Returns JSNIThreadSafeOK if the call is queued.
+    \since JSNI 2.4.
+*/
+JSNIThreadSafeCallStatus JSNICallThreadSafeFunction(JSNIThreadSafeFunction func, void* data, bool blocking);
+
+/*! \fn bool JSNIAcquireThreadSafeFunction(JSNIThreadSafeFunction func)
+    \brief Adds a reference for a new calling thread.
+    \param func The thread-safe function.
+    \return Returns false if the function is released.
+    \since JSNI 2.4.
+*/
+bool JSNIAcquireThreadSafeFunction(JSNIThreadSafeFunction func);
+
+/*! \fn void JSNIReleaseThreadSafeFunction(JSNIThreadSafeFunction func)
+    \brief Drops a reference. The function must not be used by the thread after it.
+    Once no reference is left, new calls fail and the function is finalized after the
+    queued calls are dispatched.
+    \param func The thread-safe function.
+    \since JSNI 2.4.
+*/
+void JSNIReleaseThreadSafeFunction(JSNIThreadSafeFunction func);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -988,6 +1810,11 @@ struct _JSNIEnv {
 */
 #define JSNI_VERSION_2_3 0x00020003
 
+/*! \def JSNI_VERSION_2_4
+    \brief JSNI version 2.4.
+*/
+#define JSNI_VERSION_2_4 0x00020004
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
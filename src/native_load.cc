@@ -42,9 +42,65 @@ unordered_map<int, string> jsni_version_map = {
   {JSNI_VERSION_2_1, "JSNI_VERSION_2_1"},
 };
 
-void JSNIEnvGCCallback(const WeakCallbackInfo<JSNIEnvExt>& info) {
-  JSNIEnvExt* jsni_env = reinterpret_cast<JSNIEnvExt*>(info.GetParameter());
-  delete jsni_env;
+// An env is created per context loading native modules, so every worker
+// thread and vm context gets its own. It is deleted when the context is
+// collected, or when the node environment of the isolate is torn down.
+struct JSNIEnvHolder {
+  JSNIEnvExt* env;
+  Global<External> handle;
+};
+
+void JSNIEnvCleanupHook(void* arg);
+
+void DeleteJSNIEnvHolder(JSNIEnvHolder* holder) {
+  holder->handle.Reset();
+  delete holder->env;
+  delete holder;
+}
+
+void JSNIEnvSecondPassCallback(const WeakCallbackInfo<JSNIEnvHolder>& info) {
+  DeleteJSNIEnvHolder(info.GetParameter());
+}
+
+void JSNIEnvGCCallback(const WeakCallbackInfo<JSNIEnvHolder>& info) {
+  JSNIEnvHolder* holder = info.GetParameter();
+  holder->handle.Reset();
+  node::RemoveEnvironmentCleanupHook(holder->env->GetIsolate(),
+                                     JSNIEnvCleanupHook, holder);
+  // Deleting the env runs module cleanup hooks and finalizers, which may
+  // call back into JSNI, which is only allowed in the second pass.
+  info.SetSecondPassCallback(JSNIEnvSecondPassCallback);
+}
+
+void JSNIEnvCleanupHook(void* arg) {
+  DeleteJSNIEnvHolder(reinterpret_cast<JSNIEnvHolder*>(arg));
+}
+
+// The env is kept in a private property of the global, out of reach of
+// scripts.
+JSNIEnvExt* GetJSNIEnv(Local<Context> context) {
+  Isolate* isolate = context->GetIsolate();
+  Local<Object> global = context->Global();
+  Local<Private> jsni_key = Private::ForApi(
+    isolate,
+    String::NewFromUtf8(isolate, "__jsni_env__", NewStringType::kNormal)
+      .ToLocalChecked());
+  Local<Value> jsni;
+  if (global->GetPrivate(context, jsni_key).ToLocal(&jsni) &&
+      jsni->IsExternal()) {
+    return reinterpret_cast<JSNIEnvExt*>(jsni.As<External>()->Value());
+  }
+
+  JSNIEnvExt* jsni_env = JSNIEnvExt::Create(isolate);
+  Local<External> jsni_external = External::New(isolate, jsni_env);
+  global->SetPrivate(context, jsni_key, jsni_external).FromJust();
+  JSNIEnvHolder* holder = new JSNIEnvHolder();
+  holder->env = jsni_env;
+  holder->handle.Reset(isolate, jsni_external);
+  holder->handle.SetWeak(holder, JSNIEnvGCCallback,
+                         WeakCallbackType::kParameter);
+  node::AddEnvironmentCleanupHook(isolate, JSNIEnvCleanupHook, holder);
+  return jsni_env;
 }
 
 void NativeLoad(const FunctionCallbackInfo<Value>& args) {
@@ -71,25 +127,8 @@ void NativeLoad(const FunctionCallbackInfo<Value>& args) {
 
   if (ptr != nullptr) {
 
-    // Prepare JSNIEnv* env
-    // env is set in global. First check, then use.
-    Local<Context> context = isolate->GetCurrentContext();
-    Local<Object> global = context->Global();
-    Local<String> jsni_name = String::NewFromUtf8(
-                              isolate,
-                              "__jsni_env__", NewStringType::kNormal
-                              ).ToLocalChecked();
-    Local<Value> jsni = global->Get(context, jsni_name).ToLocalChecked();
-    JSNIEnvExt* jsni_env = nullptr;
-    if (jsni->IsUndefined()) {
-      jsni_env = JSNIEnvExt::Create(isolate);
-      Local<External> jsni_external = External::New(isolate, jsni_env);
-      global->Set(jsni_name, jsni_external);
-      Persistent<Value> jsni_persistent(isolate, jsni_external);
-      jsni_persistent.SetWeak(jsni_env, JSNIEnvGCCallback, WeakCallbackType::kParameter);
-    } else {
-      jsni_env = reinterpret_cast<JSNIEnvExt*>(jsni.As<External>()->Value());
-    }
+    // Prepare JSNIEnv* env of the current context.
+    JSNIEnvExt* jsni_env = GetJSNIEnv(isolate->GetCurrentContext());
     JSNIInitFn jsni_init = reinterpret_cast<JSNIInitFn>(ptr);
     JSValueRef exports = reinterpret_cast<JSValueRef>(*native_exports);
     int version = jsni_init(jsni_env, exports);
@@ -115,8 +154,8 @@ void NativeLoad(const FunctionCallbackInfo<Value>& args) {
   }
 }
 
-void init(Local<Object> exports) {
+// Exports the well-known initializer, so that worker threads can load the
+// module again after the first load registered it.
+NODE_MODULE_INIT() {
   NODE_SET_METHOD(exports, "nativeLoad", NativeLoad);
-}
-
-NODE_MODULE(binding, init);
\ No newline at end of file
+}
\ No newline at end of file
@@ -0,0 +1,400 @@
+// JavaScript Native Interface Release License.
+//
+// Copyright (c) 2015-2018 Alibaba Group. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Alibaba Group nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <jsni.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Benchmarks of JSNI call paths. Every case is driven by benchmark.js.
+
+int accessor_data = 0;
+
+void Noop(JSNIEnv* env, JSNICallbackInfo info) {
+}
+
+void Identity(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info, JSNIGetArgOfCallback(env, info, 0));
+}
+
+void Getter(JSNIEnv* env, JSNICallbackInfo info) {
+  int* data = reinterpret_cast<int*>(JSNIGetDataOfCallback(env, info));
+  JSNISetReturnValue(env, info, JSNINewNumber(env, *data));
+}
+
+void DefineAccessor(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
+  JSNIAccessorPropertyDescriptor accessor =
+    {Getter, NULL, JSNINone, reinterpret_cast<void*>(&accessor_data)};
+  JSNIPropertyDescriptor des = {NULL, &accessor};
+  JSNIDefineProperty(env, obj, "value", des);
+}
+
+// Runs the type checks of a hot marshalling loop natively.
+void TypeChecks(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef val = JSNIGetArgOfCallback(env, info, 0);
+  int iterations = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 1));
+  int count = 0;
+  for (int i = 0; i < iterations; i++) {
+    if (JSNIIsNumber(env, val) && !JSNIIsUndefined(env, val) &&
+        JSNIStrictEquals(env, val, val)) {
+      count++;
+    }
+  }
+  JSNISetReturnValue(env, info, JSNINewNumber(env, count));
+}
+
+const char* record_fields[] = {
+  "id", "name", "price", "quantity", "timestamp", "side", "venue", "flags"
+};
+const int kRecordFieldCount = sizeof(record_fields) / sizeof(record_fields[0]);
+JSNIPropertyKey record_keys[kRecordFieldCount];
+
+// Defines an accessor per record field on a fresh object.
+void DefineAccessorsOneByOne(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNINewObject(env);
+  JSNIAccessorPropertyDescriptor accessor =
+    {Getter, NULL, JSNINone, reinterpret_cast<void*>(&accessor_data)};
+  JSNIPropertyDescriptor des = {NULL, &accessor};
+  for (int i = 0; i < kRecordFieldCount; i++) {
+    JSNIDefineProperty(env, obj, record_fields[i], des);
+  }
+  JSNISetReturnValue(env, info, obj);
+}
+
+void DefineAccessorsInBatch(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNINewObject(env);
+  JSNIAccessorPropertyDescriptor accessor =
+    {Getter, NULL, JSNINone, reinterpret_cast<void*>(&accessor_data)};
+  JSNINamedPropertyDescriptor properties[kRecordFieldCount];
+  for (int i = 0; i < kRecordFieldCount; i++) {
+    properties[i].name = record_fields[i];
+    properties[i].descriptor.data_attributes = NULL;
+    properties[i].descriptor.accessor_attributes = &accessor;
+  }
+  JSNIDefineProperties(env, obj, properties, kRecordFieldCount);
+  JSNISetReturnValue(env, info, obj);
+}
+
+// Marshals a record-shaped object field by field, the way a fixed schema
+// decoder does.
+void NewRecordByName(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNINewObject(env);
+  JSValueRef value = JSNINewNumber(env, 1);
+  for (int i = 0; i < kRecordFieldCount; i++) {
+    JSNISetProperty(env, obj, record_fields[i], value);
+  }
+  JSNISetReturnValue(env, info, obj);
+}
+
+void NewRecordByKey(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNINewObject(env);
+  JSValueRef value = JSNINewNumber(env, 1);
+  for (int i = 0; i < kRecordFieldCount; i++) {
+    JSNISetPropertyByKey(env, obj, record_keys[i], value);
+  }
+  JSNISetReturnValue(env, info, obj);
+}
+
+void NewFunction(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info, JSNINewFunction(env, Noop));
+}
+
+void GetFunction(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info, JSNIGetFunction(env, Noop));
+}
+
+// Startup cost of an addon exporting many methods.
+const int kMethodCount = 256;
+char method_names[kMethodCount][16];
+JSNIMethodDescriptor methods[kMethodCount];
+
+void RegisterMethodsOneByOne(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
+  for (int i = 0; i < kMethodCount; i++) {
+    JSNIRegisterMethod(env, obj, methods[i].name, methods[i].callback);
+  }
+}
+
+void RegisterMethodsInBatch(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
+  JSNIRegisterMethods(env, obj, methods, kMethodCount);
+}
+
+// Reads a short string argument into a stack buffer, the way a parser
+// pulls out tokens.
+void Utf8TwoPass(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef str = JSNIGetArgOfCallback(env, info, 0);
+  char buffer[256];
+  size_t length = JSNIGetStringUtf8Length(env, str);
+  if (length < sizeof(buffer)) {
+    JSNIGetStringUtf8Chars(env, str, buffer, sizeof(buffer));
+  }
+}
+
+void Utf8OnePass(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef str = JSNIGetArgOfCallback(env, info, 0);
+  char buffer[256];
+  JSNIWriteStringUtf8(env, str, buffer, sizeof(buffer));
+}
+
+void StringView(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef str = JSNIGetArgOfCallback(env, info, 0);
+  JSNIStringView view;
+  JSNIGetStringView(env, str, &view);
+  JSNIReleaseStringView(env, &view);
+}
+
+// Converts a JS array to native values and back.
+void CopyArrayOneByOne(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef array = JSNIGetArgOfCallback(env, info, 0);
+  size_t length = JSNIGetArrayLength(env, array);
+  std::vector<JSValueRef> elements(length);
+  for (size_t i = 0; i < length; i++) {
+    elements[i] = JSNIGetArrayElement(env, array, i);
+  }
+  JSValueRef copy = JSNINewArray(env, 0);
+  for (size_t i = 0; i < length; i++) {
+    JSNISetArrayElement(env, copy, i, elements[i]);
+  }
+  JSNISetReturnValue(env, info, copy);
+}
+
+void CopyArrayInBulk(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef array = JSNIGetArgOfCallback(env, info, 0);
+  size_t length = JSNIGetArrayLength(env, array);
+  std::vector<JSValueRef> elements(length);
+  JSNIGetArrayElements(env, array, 0, length, elements.data());
+  JSNISetReturnValue(env, info,
+                     JSNINewArrayFrom(env, elements.data(), length));
+}
+
+// Sums a JS array of numbers natively.
+void SumDoublesOneByOne(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef array = JSNIGetArgOfCallback(env, info, 0);
+  size_t length = JSNIGetArrayLength(env, array);
+  double sum = 0;
+  for (size_t i = 0; i < length; i++) {
+    sum += JSNIToCDouble(env, JSNIGetArrayElement(env, array, i));
+  }
+  JSNISetReturnValue(env, info, JSNINewNumber(env, sum));
+}
+
+void SumDoublesInBulk(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef array = JSNIGetArgOfCallback(env, info, 0);
+  size_t length = JSNIGetArrayLength(env, array);
+  std::vector<double> data(length);
+  JSNIGetArrayAsDoubles(env, array, data.data(), length);
+  double sum = 0;
+  for (size_t i = 0; i < length; i++) {
+    sum += data[i];
+  }
+  JSNISetReturnValue(env, info, JSNINewNumber(env, sum));
+}
+
+std::vector<double> native_doubles(100000, 0.5);
+
+void NewDoublesOneByOne(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef array = JSNINewArray(env, 0);
+  for (size_t i = 0; i < native_doubles.size(); i++) {
+    JSNISetArrayElement(env, array, i, JSNINewNumber(env, native_doubles[i]));
+  }
+  JSNISetReturnValue(env, info, array);
+}
+
+void NewDoublesInBulk(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info,
+                     JSNINewArrayFromDoubles(env, native_doubles.data(),
+                                             native_doubles.size()));
+}
+
+// Opens a scope per iteration, as a loop creating temporaries should.
+void LocalScopes(JSNIEnv* env, JSNICallbackInfo info) {
+  int iterations = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 0));
+  for (int i = 0; i < iterations; i++) {
+    JSNIPushLocalScope(env);
+    JSNINewNumber(env, i);
+    JSNIPopLocalScope(env);
+  }
+}
+
+void EscapableLocalScopes(JSNIEnv* env, JSNICallbackInfo info) {
+  int iterations = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 0));
+  // Collects the escaped values of all iterations.
+  JSNIPushLocalScope(env);
+  for (int i = 0; i < iterations; i++) {
+    JSNIPushEscapableLocalScope(env);
+    JSNIPopEscapableLocalScope(env, JSNINewNumber(env, i));
+  }
+  JSNIPopLocalScope(env);
+}
+
+// Holds a global reference per element, then drops them all, the way a
+// cache of callbacks per connection does.
+void HoldGlobalValues(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef array = JSNIGetArgOfCallback(env, info, 0);
+  size_t length = JSNIGetArrayLength(env, array);
+  std::vector<JSGlobalValueRef> refs(length);
+  for (size_t i = 0; i < length; i++) {
+    JSNIPushLocalScope(env);
+    refs[i] = JSNINewGlobalValue(env, JSNIGetArrayElement(env, array, i));
+    JSNIPopLocalScope(env);
+  }
+  for (size_t i = 0; i < length; i++) {
+    JSNIDeleteGlobalValue(env, refs[i]);
+  }
+}
+
+// A wrapped native object keeps its pointer both boxed and aligned, so the
+// two ways of finding it from a method call can be compared.
+struct Counter {
+  int count;
+};
+
+void CounterConstructor(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef self = JSNIGetThisOfCallback(env, info);
+  static Counter counter = {0};
+  JSNISetInternalField(env, self, 0, &counter);
+  JSNISetAlignedInternalField(env, self, 1, &counter);
+}
+
+void IncrementBoxed(JSNIEnv* env, JSNICallbackInfo info) {
+  Counter* counter = static_cast<Counter*>(
+    JSNIGetInternalField(env, JSNIGetThisOfCallback(env, info), 0));
+  counter->count++;
+}
+
+void IncrementAligned(JSNIEnv* env, JSNICallbackInfo info) {
+  Counter* counter = static_cast<Counter*>(
+    JSNIGetAlignedInternalField(env, JSNIGetThisOfCallback(env, info), 1));
+  counter->count++;
+}
+
+void DefineCounter(JSNIEnv* env, JSValueRef exports) {
+  static const JSNIMethodDescriptor methods[] = {
+    {"incrementBoxed", IncrementBoxed, JSNINone},
+    {"incrementAligned", IncrementAligned, JSNINone},
+  };
+  static const JSNIAccessorDescriptor accessors[] = {
+    {"value", Getter, NULL, JSNINone, &accessor_data},
+  };
+  static const JSNIAccessorDescriptor instance_accessors[] = {
+    {"ownValue", Getter, NULL, JSNINone, &accessor_data},
+  };
+  JSNIClassDescriptor descriptor = {
+    "Counter", CounterConstructor, 2, methods, 2, accessors, 1,
+    instance_accessors, 1, NULL, NULL
+  };
+  JSNISetProperty(env, exports, "Counter", JSNIDefineClass(env, &descriptor));
+}
+
+// A wide row of a column store, either copied into an object field by field
+// or produced lazily by an interceptor when a column is read.
+const int kWideRowColumnCount = 100;
+char wide_row_columns[kWideRowColumnCount][8];
+JSNIPropertyKey wide_row_keys[kWideRowColumnCount];
+
+void NewWideRowEagerly(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef obj = JSNINewObject(env);
+  for (int i = 0; i < kWideRowColumnCount; i++) {
+    JSNISetPropertyByKey(env, obj, wide_row_keys[i], JSNINewNumber(env, i));
+  }
+  JSNISetReturnValue(env, info, obj);
+}
+
+void WideRowConstructor(JSNIEnv* env, JSNICallbackInfo info) {
+}
+
+void WideRowGetter(JSNIEnv* env, JSNICallbackInfo info) {
+  char name[8];
+  JSValueRef property = JSNIGetPropertyOfCallback(env, info);
+  if (JSNIWriteStringUtf8(env, property, name, sizeof(name)) < sizeof(name) &&
+      name[0] == 'c') {
+    JSNISetReturnValue(env, info, JSNINewNumber(env, atoi(name + 1)));
+  }
+}
+
+void DefineWideRow(JSNIEnv* env, JSValueRef exports) {
+  for (int i = 0; i < kWideRowColumnCount; i++) {
+    snprintf(wide_row_columns[i], sizeof(wide_row_columns[i]), "c%d", i);
+    wide_row_keys[i] = JSNINewPropertyKey(env, wide_row_columns[i]);
+  }
+  static const JSNIInterceptorDescriptor interceptor = {
+    WideRowGetter, NULL, NULL, NULL, NULL, NULL
+  };
+  JSNIClassDescriptor descriptor = {
+    "WideRow", WideRowConstructor, 0, NULL, 0, NULL, 0, NULL, 0,
+    &interceptor, NULL
+  };
+  JSNISetProperty(env, exports, "WideRow", JSNIDefineClass(env, &descriptor));
+}
+
+int JSNIInit(JSNIEnv* env, JSValueRef exports) {
+  for (int i = 0; i < kMethodCount; i++) {
+    snprintf(method_names[i], sizeof(method_names[i]), "method%d", i);
+    methods[i].name = method_names[i];
+    methods[i].callback = Noop;
+    methods[i].attributes = JSNINone;
+  }
+
+  for (int i = 0; i < kRecordFieldCount; i++) {
+    record_keys[i] = JSNINewPropertyKey(env, record_fields[i]);
+  }
+
+  JSNIRegisterMethod(env, exports, "noop", Noop);
+  JSNIRegisterMethod(env, exports, "identity", Identity);
+  JSNIRegisterMethod(env, exports, "defineAccessor", DefineAccessor);
+  JSNIRegisterMethod(env, exports, "typeChecks", TypeChecks);
+  JSNIRegisterMethod(env, exports, "defineAccessorsOneByOne",
+                     DefineAccessorsOneByOne);
+  JSNIRegisterMethod(env, exports, "defineAccessorsInBatch",
+                     DefineAccessorsInBatch);
+  JSNIRegisterMethod(env, exports, "newRecordByName", NewRecordByName);
+  JSNIRegisterMethod(env, exports, "newRecordByKey", NewRecordByKey);
+  JSNIRegisterMethod(env, exports, "newFunction", NewFunction);
+  JSNIRegisterMethod(env, exports, "getFunction", GetFunction);
+  JSNIRegisterMethod(env, exports, "registerMethodsOneByOne",
+                     RegisterMethodsOneByOne);
+  JSNIRegisterMethod(env, exports, "registerMethodsInBatch",
+                     RegisterMethodsInBatch);
+  JSNIRegisterMethod(env, exports, "utf8TwoPass", Utf8TwoPass);
+  JSNIRegisterMethod(env, exports, "utf8OnePass", Utf8OnePass);
+  JSNIRegisterMethod(env, exports, "stringView", StringView);
+  JSNIRegisterMethod(env, exports, "copyArrayOneByOne", CopyArrayOneByOne);
+  JSNIRegisterMethod(env, exports, "copyArrayInBulk", CopyArrayInBulk);
+  JSNIRegisterMethod(env, exports, "sumDoublesOneByOne", SumDoublesOneByOne);
+  JSNIRegisterMethod(env, exports, "sumDoublesInBulk", SumDoublesInBulk);
+  JSNIRegisterMethod(env, exports, "newDoublesOneByOne", NewDoublesOneByOne);
+  JSNIRegisterMethod(env, exports, "newDoublesInBulk", NewDoublesInBulk);
+  JSNIRegisterMethod(env, exports, "holdGlobalValues", HoldGlobalValues);
+  DefineCounter(env, exports);
+  JSNIRegisterMethod(env, exports, "newWideRowEagerly", NewWideRowEagerly);
+  DefineWideRow(env, exports);
+  JSNIRegisterMethod(env, exports, "localScopes", LocalScopes);
+  JSNIRegisterMethod(env, exports, "escapableLocalScopes",
+                     EscapableLocalScopes);
+  return JSNI_VERSION_2_4;
+}
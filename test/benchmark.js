@@ -0,0 +1,292 @@
+// JavaScript Native Interface Release License.
+//
+// Copyright (c) 2015-2018 Alibaba Group. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//     * Redistributions of source code must retain the above copyright
+//       notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of the Alibaba Group nor the
+//       names of its contributors may be used to endorse or promote products
+//       derived from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL <COPYRIGHT HOLDER> BE LIABLE FOR ANY
+// DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Micro benchmarks of JSNI call paths.
+// Usage: node --expose-gc benchmark.js [filter]
+
+const jsni = require('../index');
+var native = nativeLoad('benchmark');
+
+function bench(name, iterations, fn) {
+  // Warm up so that the measured loop runs optimized code.
+  fn(Math.min(iterations, 10000));
+  if (global.gc) {
+    global.gc();
+  }
+  var start = process.hrtime();
+  fn(iterations);
+  var elapsed = process.hrtime(start);
+  var seconds = elapsed[0] + elapsed[1] / 1e9;
+  var rate = Math.round(iterations / seconds);
+  console.log(name + ': ' + rate.toLocaleString() + ' ops/sec');
+}
+
+function benchNoop(n) {
+  for (var i = 0; i < n; i++) {
+    native.noop();
+  }
+}
+
+function benchIdentity(n) {
+  for (var i = 0; i < n; i++) {
+    native.identity(i);
+  }
+}
+
+var accessorObject = {};
+native.defineAccessor(accessorObject);
+
+function benchGetter(n) {
+  var sum = 0;
+  for (var i = 0; i < n; i++) {
+    sum += accessorObject.value;
+  }
+  return sum;
+}
+
+// Each iteration defines 8 accessors on a fresh object.
+function benchDefineAccessorsOneByOne(n) {
+  for (var i = 0; i < n; i++) {
+    native.defineAccessorsOneByOne();
+  }
+}
+
+function benchDefineAccessorsInBatch(n) {
+  for (var i = 0; i < n; i++) {
+    native.defineAccessorsInBatch();
+  }
+}
+
+function benchTypeChecks(n) {
+  // Three type checks per iteration.
+  native.typeChecks(1, n / 3);
+}
+
+function benchRecordByName(n) {
+  for (var i = 0; i < n; i++) {
+    native.newRecordByName();
+  }
+}
+
+function benchRecordByKey(n) {
+  for (var i = 0; i < n; i++) {
+    native.newRecordByKey();
+  }
+}
+
+function benchNewFunction(n) {
+  for (var i = 0; i < n; i++) {
+    native.newFunction();
+  }
+}
+
+function benchGetFunction(n) {
+  for (var i = 0; i < n; i++) {
+    native.getFunction();
+  }
+}
+
+// Each iteration registers 256 methods on a fresh exports object.
+function benchRegisterOneByOne(n) {
+  for (var i = 0; i < n; i++) {
+    native.registerMethodsOneByOne({});
+  }
+}
+
+function benchRegisterInBatch(n) {
+  for (var i = 0; i < n; i++) {
+    native.registerMethodsInBatch({});
+  }
+}
+
+var token = 'quantity_' + 'remaining_on_the_book';
+
+function benchUtf8TwoPass(n) {
+  for (var i = 0; i < n; i++) {
+    native.utf8TwoPass(token);
+  }
+}
+
+function benchUtf8OnePass(n) {
+  for (var i = 0; i < n; i++) {
+    native.utf8OnePass(token);
+  }
+}
+
+function benchStringView(n) {
+  for (var i = 0; i < n; i++) {
+    native.stringView(token);
+  }
+}
+
+var largeArray = [];
+for (var i = 0; i < 100000; i++) {
+  largeArray.push({index: i});
+}
+
+// Each iteration copies a 100k-element array through native code.
+function benchCopyArrayOneByOne(n) {
+  for (var i = 0; i < n; i++) {
+    native.copyArrayOneByOne(largeArray);
+  }
+}
+
+function benchCopyArrayInBulk(n) {
+  for (var i = 0; i < n; i++) {
+    native.copyArrayInBulk(largeArray);
+  }
+}
+
+var largeDoubles = [];
+for (var i = 0; i < 100000; i++) {
+  largeDoubles.push(i + 0.5);
+}
+
+// Each iteration moves 100k numbers between JS and a native buffer.
+function benchSumDoublesOneByOne(n) {
+  for (var i = 0; i < n; i++) {
+    native.sumDoublesOneByOne(largeDoubles);
+  }
+}
+
+function benchSumDoublesInBulk(n) {
+  for (var i = 0; i < n; i++) {
+    native.sumDoublesInBulk(largeDoubles);
+  }
+}
+
+function benchNewDoublesOneByOne(n) {
+  for (var i = 0; i < n; i++) {
+    native.newDoublesOneByOne();
+  }
+}
+
+function benchNewDoublesInBulk(n) {
+  for (var i = 0; i < n; i++) {
+    native.newDoublesInBulk();
+  }
+}
+
+var counter = new native.Counter();
+
+function benchIncrementBoxed(n) {
+  for (var i = 0; i < n; i++) {
+    counter.incrementBoxed();
+  }
+}
+
+function benchIncrementAligned(n) {
+  for (var i = 0; i < n; i++) {
+    counter.incrementAligned();
+  }
+}
+
+// Wrapped objects with one accessor, defined on each object or shared
+// through the class.
+function benchNewPerInstanceAccessor(n) {
+  for (var i = 0; i < n; i++) {
+    native.defineAccessor({});
+  }
+}
+
+function benchNewClassInstance(n) {
+  for (var i = 0; i < n; i++) {
+    new native.Counter();
+  }
+}
+
+// A row of 100 columns of which one is read, copied eagerly or produced by
+// an interceptor.
+function benchWideRowEagerly(n) {
+  for (var i = 0; i < n; i++) {
+    native.newWideRowEagerly().c42;
+  }
+}
+
+function benchWideRowLazily(n) {
+  for (var i = 0; i < n; i++) {
+    new native.WideRow().c42;
+  }
+}
+
+// Each iteration creates and deletes a global value per array element.
+function benchHoldGlobalValues(n) {
+  for (var i = 0; i < n; i++) {
+    native.holdGlobalValues(largeArray);
+  }
+}
+
+// The scopes are pushed and popped in a native loop.
+function benchLocalScopes(n) {
+  native.localScopes(n);
+}
+
+function benchEscapableLocalScopes(n) {
+  native.escapableLocalScopes(n);
+}
+
+var benchmarks = [
+  ['call noop', 5e6, benchNoop],
+  ['call identity', 5e6, benchIdentity],
+  ['accessor getter', 5e6, benchGetter],
+  ['define 8 accessors one by one', 5e5, benchDefineAccessorsOneByOne],
+  ['define 8 accessors in batch', 5e5, benchDefineAccessorsInBatch],
+  ['native type checks', 3e7, benchTypeChecks],
+  ['record by name', 1e6, benchRecordByName],
+  ['record by key', 1e6, benchRecordByKey],
+  ['JSNINewFunction', 1e6, benchNewFunction],
+  ['JSNIGetFunction', 1e6, benchGetFunction],
+  ['register 256 methods one by one', 2e3, benchRegisterOneByOne],
+  ['register 256 methods in batch', 2e3, benchRegisterInBatch],
+  ['utf8 length then copy', 3e6, benchUtf8TwoPass],
+  ['utf8 single write', 3e6, benchUtf8OnePass],
+  ['string view', 3e6, benchStringView],
+  ['copy 100k array one by one', 100, benchCopyArrayOneByOne],
+  ['copy 100k array in bulk', 100, benchCopyArrayInBulk],
+  ['read 100k doubles one by one', 100, benchSumDoublesOneByOne],
+  ['read 100k doubles in bulk', 100, benchSumDoublesInBulk],
+  ['write 100k doubles one by one', 100, benchNewDoublesOneByOne],
+  ['write 100k doubles in bulk', 100, benchNewDoublesInBulk],
+  ['wrapped method, boxed field', 5e6, benchIncrementBoxed],
+  ['wrapped method, aligned field', 5e6, benchIncrementAligned],
+  ['new object, per-instance accessor', 1e6, benchNewPerInstanceAccessor],
+  ['new object, class accessors', 1e6, benchNewClassInstance],
+  ['wide row, eager fields', 1e5, benchWideRowEagerly],
+  ['wide row, interceptor', 1e5, benchWideRowLazily],
+  ['hold 100k global values', 100, benchHoldGlobalValues],
+  ['push/pop local scope', 1e7, benchLocalScopes],
+  ['push/pop escapable local scope', 1e7, benchEscapableLocalScopes],
+];
+
+var filter = process.argv[2];
+
+benchmarks.forEach(function(b) {
+  if (filter === undefined || b[0].indexOf(filter) !== -1) {
+    bench(b[0], b[1], b[2]);
+  }
+});
+
+process.exit();
@@ -9,6 +9,16 @@
       "libraries": [
         "<(module_root_dir)/../build/<!@(node -p \"process.config.target_defaults.default_configuration\")/jsni.a"
       ],
+    },
+    {
+      "target_name": "benchmark",
+      "sources": ["benchmark.cc"],
+      "include_dirs": [
+        "<!@(node -p \"require('../index').include\")"
+      ],
+      "libraries": [
+        "<(module_root_dir)/../build/<!@(node -p \"process.config.target_defaults.default_configuration\")/jsni.a"
+      ],
     }
 
   ]
@@ -25,11 +25,14 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <execinfo.h>
+#include <unistd.h>
 #include <cmath>
+#include <thread>
 
 #include <v8.h>
 #include "test-api.h"
@@ -86,6 +89,94 @@ TEST(Array) {
   JSNISetReturnValue(env, info, new_array);
 }
 
+TEST(ArrayElements) {
+  JSValueRef array = JSNIGetArgOfCallback(env, info, 0);
+  assert(JSNIGetArrayLength(env, JSNINewArray(env, 3)) == 3);
+
+  JSValueRef elements[4];
+  size_t count = JSNIGetArrayElements(env, array, 1, 4, elements);
+  // Only three elements from index 1.
+  assert(count == 3);
+  assert(JSNIToInt32(env, elements[0]) == 2);
+  assert(JSNIToInt32(env, elements[2]) == 4);
+  assert(JSNIGetArrayElements(env, array, 4, 1, elements) == 0);
+
+  // Reversed copy of the whole array.
+  JSValueRef reversed[4];
+  count = JSNIGetArrayElements(env, array, 0, 4, reversed);
+  for (size_t i = 0; i < count / 2; i++) {
+    JSValueRef tmp = reversed[i];
+    reversed[i] = reversed[count - 1 - i];
+    reversed[count - 1 - i] = tmp;
+  }
+  JSValueRef new_array = JSNINewArrayFrom(env, reversed, count);
+  assert(JSNIGetArrayLength(env, new_array) == 4);
+
+  // Append past the end.
+  assert(JSNISetArrayElements(env, new_array, 4, 2, elements));
+  assert(JSNIGetArrayLength(env, new_array) == 6);
+
+  assert(!JSNISetArrayElements(env, JSNINewObject(env), 0, 1, elements));
+  AssertHelper(env);
+  JSNISetReturnValue(env, info, new_array);
+}
+
+TEST(NumberArray) {
+  JSValueRef doubles = JSNIGetArgOfCallback(env, info, 0);
+  JSValueRef holey = JSNIGetArgOfCallback(env, info, 1);
+  size_t length = JSNIGetArrayLength(env, doubles);
+
+  double* double_data = static_cast<double*>(malloc(length * sizeof(double)));
+  assert(JSNIGetArrayAsDoubles(env, doubles, double_data, length) == length);
+  for (size_t i = 0; i < length; i++) {
+    assert(double_data[i] == i + 0.5);
+  }
+  int32_t* int32_data = static_cast<int32_t*>(malloc(length * sizeof(int32_t)));
+  assert(JSNIGetArrayAsInt32s(env, doubles, int32_data, length) == length);
+  assert(int32_data[length - 1] == static_cast<int32_t>(length - 1));
+  // Partial copy.
+  assert(JSNIGetArrayAsDoubles(env, doubles, double_data, 2) == 2);
+
+  // Holes and non-numbers are converted like TypedArray.prototype.set does.
+  double holey_data[4];
+  assert(JSNIGetArrayAsDoubles(env, holey, holey_data, 4) == 3);
+  assert(holey_data[0] == 1);
+  assert(std::isnan(holey_data[1]));
+  assert(holey_data[2] == 3);
+
+  assert(JSNIGetArrayAsDoubles(env, JSNINewObject(env), holey_data, 4) == 0);
+  AssertHelper(env);
+
+  JSValueRef result = JSNINewArrayFromInt32s(env, int32_data, length);
+  free(double_data);
+  free(int32_data);
+  JSNISetReturnValue(env, info, result);
+}
+
+TEST(NumberArrayThrow) {
+  double double_data[100];
+  int32_t int32_data[100];
+  // Below and above the length copied in bulk.
+  for (int i = 0; i < 2; i++) {
+    JSValueRef array = JSNIGetArgOfCallback(env, info, i);
+    size_t length = JSNIGetArrayLength(env, array);
+    assert(length <= 100);
+    assert(JSNIGetArrayAsDoubles(env, array, double_data, length) == 0);
+    AssertHelper(env);
+    assert(JSNIHasException(env));
+    JSNIClearException(env);
+    assert(JSNIGetArrayAsInt32s(env, array, int32_data, length) == 0);
+    AssertHelper(env);
+    assert(JSNIHasException(env));
+    JSNIClearException(env);
+  }
+}
+
+TEST(NewArrayFromDoubles) {
+  const double data[] = {0.5, 1.5, 2.5};
+  JSNISetReturnValue(env, info, JSNINewArrayFromDoubles(env, data, 3));
+}
+
 TEST(Boolean) {
   JSValueRef bool_val = JSNINewBoolean(env, true);
   assert(JSNIIsBoolean(env, bool_val));
@@ -257,6 +348,25 @@ TEST(NewNativeFunction) {
   JSNISetReturnValue(env, info, func);
 }
 
+TEST(GetFunction) {
+  JSValueRef func = JSNIGetFunction(env, TestNativeFunction);
+  assert(JSNIStrictEquals(env, func, JSNIGetFunction(env, TestNativeFunction)));
+  JSValueRef new_func = JSNINewFunction(env, TestNativeFunction);
+  assert(!JSNIStrictEquals(env, func, new_func));
+  assert(!JSNIStrictEquals(env, new_func,
+                           JSNINewFunction(env, TestNativeFunction)));
+  JSNISetReturnValue(env, info, func);
+}
+
+TEST(RegisterMethods) {
+  JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
+  const JSNIMethodDescriptor methods[] = {
+    {"native", TestNativeFunction, JSNINone},
+    {"hidden", TestNativeFunction, JSNIDontEnum},
+  };
+  assert(JSNIRegisterMethods(env, obj, methods, 2));
+}
+
 TEST(IsFunction) {
   if (JSNIGetArgsLengthOfCallback(env, info) < 1) {
     // JSNIThrowRangeErrorException(env, "Arguments should be more than 0.");
@@ -294,6 +404,12 @@ TEST(Global) {
   JSNISetReturnValue(env, info, num_from_global);
 
   JSNIDeleteGlobalValue(env, num_global);
+  assert(JSNIGetLastErrorInfo(env).error_code == 0);
+  // A deleted global value is detected until its slot is reused.
+  assert(JSNIGetGlobalValue(env, num_global) == NULL);
+  assert(JSNIGetLastErrorInfo(env).error_code != 0);
+  JSNIDeleteGlobalValue(env, num_global);
+  assert(JSNIGetLastErrorInfo(env).error_code != 0);
 }
 
 TEST(GlobalGC) {
@@ -331,6 +447,66 @@ TEST(GCCallback) {
   assert(global_native_1 == 201);
 }
 
+TEST(WeakGlobal) {
+  JSNIPushLocalScope(env);
+  JSGlobalValueRef collected = JSNINewWeakGlobalValue(env, JSNINewObject(env));
+  JSValueRef obj = JSNINewObject(env);
+  JSGlobalValueRef strong = JSNINewGlobalValue(env, obj);
+  JSGlobalValueRef kept = JSNINewWeakGlobalValue(env, obj);
+  JSNIPopLocalScope(env);
+  assert(JSNIIsGlobalValueAlive(env, collected));
+
+  RequestGC();
+  assert(!JSNIIsGlobalValueAlive(env, collected));
+  assert(JSNIGetGlobalValue(env, collected) == NULL);
+  assert(!JSNIMakeGlobalValueStrong(env, collected));
+  JSNIDeleteGlobalValue(env, collected);
+
+  // The strong global value keeps the object alive, then the upgraded one.
+  assert(JSNIIsGlobalValueAlive(env, kept));
+  assert(JSNIMakeGlobalValueStrong(env, kept));
+  JSNIDeleteGlobalValue(env, strong);
+  RequestGC();
+  JSNIPushLocalScope(env);
+  assert(JSNIIsObject(env, JSNIGetGlobalValue(env, kept)));
+  JSNIPopLocalScope(env);
+  assert(JSNIMakeGlobalValueWeak(env, kept));
+  RequestGC();
+  assert(!JSNIIsGlobalValueAlive(env, kept));
+  JSNIDeleteGlobalValue(env, kept);
+}
+
+void FreeWrappedData(JSNIEnv* env, void* data) {
+  free(data);
+}
+
+TEST(ExternalMemory) {
+  const int64_t kSize = 1 << 20;
+  int64_t base = JSNIAdjustExternalMemory(env, 0);
+  assert(JSNIAdjustExternalMemory(env, kSize) == base + kSize);
+  assert(JSNIAdjustExternalMemory(env, -kSize) == base);
+
+  JSGlobalValueRef deleted = JSNINewGlobalValue(env, JSNINewObject(env));
+  JSNIAttachExternalMemory(env, deleted, kSize);
+  assert(JSNIAdjustExternalMemory(env, 0) == base + kSize);
+  JSNIDeleteGlobalValue(env, deleted);
+  assert(JSNIAdjustExternalMemory(env, 0) == base);
+
+  // A wrapper releases its native memory once collected.
+  JSNIPushLocalScope(env);
+  JSValueRef wrapper = JSNINewObjectWithInternalField(env, 1);
+  void* data = malloc(kSize);
+  JSNISetInternalField(env, wrapper, 0, data);
+  JSGlobalValueRef collected = JSNINewGlobalValue(env, wrapper);
+  JSNISetGCCallback(env, collected, data, FreeWrappedData);
+  JSNIAttachExternalMemory(env, collected, kSize);
+  JSNIDeleteGlobalValue(env, collected);
+  JSNIPopLocalScope(env);
+  int64_t attached = JSNIAdjustExternalMemory(env, 0);
+  RequestGC();
+  assert(JSNIAdjustExternalMemory(env, 0) <= attached - kSize);
+}
+
 int global_native_2 = 200;
 void nativeGCCallback_2(JSNIEnv* env, void* info) {
   int get_global_native = *reinterpret_cast<int*>(info);
@@ -358,6 +534,13 @@ TEST(AcquireRelease) {
   }
 }
 
+// This function is just for testing the correctness of JSNI API.
+int getNumHandlesInternal() {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  int num_handles = v8::HandleScope::NumberOfHandles(isolate);
+  return num_handles;
+}
+
 TEST(Hidden) {
   int field_int = 123;
   JSValueRef object = JSNINewObjectWithInternalField(env, 1);
@@ -366,13 +549,12 @@ TEST(Hidden) {
   void* field_ptr = JSNIGetInternalField(env, object, 0);
   int field_int_get = *reinterpret_cast<int*>(field_ptr);
   assert(field_int_get == field_int);
-}
 
-// This function is just for testing the correctness of JSNI API.
-int getNumHandlesInternal() {
-  v8::Isolate* isolate = v8::Isolate::GetCurrent();
-  int num_handles = v8::HandleScope::NumberOfHandles(isolate);
-  return num_handles;
+  JSValueRef aligned = JSNINewObjectWithInternalField(env, 2);
+  int num_handles = getNumHandlesInternal();
+  JSNISetAlignedInternalField(env, aligned, 1, &field_int);
+  assert(JSNIGetAlignedInternalField(env, aligned, 1) == &field_int);
+  assert(getNumHandlesInternal() == num_handles);
 }
 
 TEST(LocalScope) {
@@ -472,6 +654,33 @@ TEST(Object) {
   assert(!JSNIHasProperty(env, obj, "property1"));
 }
 
+TEST(PropertyKey) {
+  JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
+  JSNIPropertyKey key = JSNINewPropertyKey(env, "keyed");
+  JSNIPropertyKey value_key = JSNINewPropertyKey(env, "value");
+
+  assert(JSNIHasPropertyByKey(env, obj, value_key));
+  JSValueRef value = JSNIGetPropertyByKey(env, obj, value_key);
+  assert(JSNIToCDouble(env, value) == 100);
+
+  assert(JSNISetPropertyByKey(env, obj, key, JSNINewNumber(env, 200)));
+  assert(JSNIHasPropertyByKey(env, obj, key));
+  assert(JSNIToCDouble(env, JSNIGetProperty(env, obj, "keyed")) == 200);
+  assert(JSNIDeletePropertyByKey(env, obj, key));
+  assert(!JSNIHasPropertyByKey(env, obj, key));
+
+  JSNIDataPropertyDescriptor data = {JSNINewNumber(env, 300), JSNIReadOnly};
+  JSNIPropertyDescriptor des = {&data, NULL};
+  assert(JSNIDefinePropertyByKey(env, obj, key, des));
+
+  // Not an object.
+  JSNIGetPropertyByKey(env, JSNINewNumber(env, 1), key);
+  AssertHelper(env);
+
+  JSNIDeletePropertyKey(env, key);
+  JSNIDeletePropertyKey(env, value_key);
+}
+
 TEST(GetProto) {
   JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
   JSValueRef proto = JSNIGetPrototype(env, obj);
@@ -542,6 +751,31 @@ TEST(DefineProperty2) {
   JSNIDefineProperty(env, obj, "abc_2", des);
 }
 
+int property_count = 0;
+
+void CountGetter(JSNIEnv* env, JSNICallbackInfo info) {
+  assert(JSNIGetDataOfCallback(env, info) == NULL);
+  JSNISetReturnValue(env, info, JSNINewNumber(env, property_count));
+}
+
+void CountSetter(JSNIEnv* env, JSNICallbackInfo info) {
+  property_count = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 0));
+}
+
+TEST(DefineProperties) {
+  JSValueRef obj = JSNIGetArgOfCallback(env, info, 0);
+  JSNIDataPropertyDescriptor answer = {JSNINewNumber(env, 42), JSNIReadOnly};
+  JSNIAccessorPropertyDescriptor count =
+    {CountGetter, CountSetter, JSNINone, NULL};
+  JSNINamedPropertyDescriptor properties[] = {
+    {"answer", {&answer, NULL}},
+    {"count", {NULL, &count}},
+    {"count2", {NULL, &count}},
+  };
+  assert(JSNIDefineProperties(env, obj, properties, 3));
+  assert(!JSNIDefineProperties(env, JSNINewNumber(env, 1), properties, 3));
+}
+
 TEST(Utf8) {
   JSValueRef value = JSNIGetArgOfCallback(env, info, 0);
   assert(JSNIIsString(env, value));
@@ -576,6 +810,105 @@ TEST(String) {
   }
 }
 
+TEST(Latin1) {
+  const char src[] = "caf\xe9";
+  JSValueRef string = JSNINewStringFromLatin1(env, src, -1);
+  API_ASSERT(JSNIGetStringLength(env, string) == 4, "JSNINewStringFromLatin1");
+  // U+00E9 takes two bytes in UTF-8.
+  API_ASSERT(JSNIGetStringUtf8Length(env, string) == 5, "JSNINewStringFromLatin1");
+
+  char copy[5];
+  size_t copied_length = JSNIGetStringLatin1Chars(env, string, copy, -1);
+  API_ASSERT(copied_length == 4, "JSNIGetStringLatin1Chars");
+  API_ASSERT(strcmp(copy, src) == 0, "JSNIGetStringLatin1Chars");
+
+  JSNISetReturnValue(env, info, string);
+}
+
+TEST(WriteStringUtf8) {
+  JSValueRef string = JSNIGetArgOfCallback(env, info, 0);
+  size_t utf8_length = JSNIGetStringUtf8Length(env, string);
+
+  char small[4];
+  size_t length = JSNIWriteStringUtf8(env, string, small, sizeof(small));
+  API_ASSERT(length == utf8_length, "JSNIWriteStringUtf8");
+  API_ASSERT(JSNIWriteStringUtf8(env, string, NULL, 0) == utf8_length,
+             "JSNIWriteStringUtf8");
+
+  char large[64];
+  length = JSNIWriteStringUtf8(env, string, large, sizeof(large));
+  API_ASSERT(length == utf8_length && large[length] == '\0',
+             "JSNIWriteStringUtf8");
+
+  JSNISetReturnValue(env, info, JSNINewStringFromUtf8(env, large, length));
+}
+
+TEST(StringView) {
+  JSValueRef one_byte = JSNIGetArgOfCallback(env, info, 0);
+  JSValueRef two_byte = JSNIGetArgOfCallback(env, info, 1);
+
+  JSNIStringView view;
+  API_ASSERT(JSNIGetStringView(env, one_byte, &view), "JSNIGetStringView");
+  API_ASSERT(view.encoding == JSNIOneByte, "JSNIGetStringView");
+  API_ASSERT(view.length == JSNIGetStringLength(env, one_byte),
+             "JSNIGetStringView");
+  API_ASSERT(memcmp(view.data, "hello", 5) == 0, "JSNIGetStringView");
+  JSNIReleaseStringView(env, &view);
+
+  // Longer than the inline storage.
+  API_ASSERT(JSNIGetStringView(env, two_byte, &view), "JSNIGetStringView");
+  API_ASSERT(view.encoding == JSNITwoByte, "JSNIGetStringView");
+  API_ASSERT(view.length == JSNIGetStringLength(env, two_byte),
+             "JSNIGetStringView");
+  const uint16_t* chars = static_cast<const uint16_t*>(view.data);
+  for (size_t i = 0; i < view.length; i++) {
+    API_ASSERT(chars[i] == 0x4E2D, "JSNIGetStringView");
+  }
+  JSNIReleaseStringView(env, &view);
+
+  JSValueRef number = JSNINewNumber(env, 1);
+  API_ASSERT(!JSNIGetStringView(env, number, &view), "JSNIGetStringView");
+  AssertHelper(env);
+}
+
+int released_strings = 0;
+void nativeReleaseString(JSNIEnv* env, void* data, void* hint) {
+  assert(hint == &released_strings);
+  released_strings += 1;
+}
+
+const char external_latin1[] = "an external caf\xe9 string";
+const uint16_t external_two_byte[] = {0x4E2D, 0x6587, 0x5B57, 0x7B26};
+
+TEST(ExternalString) {
+  JSNIPushLocalScope(env);
+  size_t length = strlen(external_latin1);
+  int64_t external_memory = JSNIAdjustExternalMemory(env, 0);
+  JSValueRef latin1 = JSNINewExternalStringLatin1(
+    env, external_latin1, length, nativeReleaseString, &released_strings);
+  API_ASSERT(JSNIAdjustExternalMemory(env, 0) ==
+             external_memory + (int64_t)length, "JSNINewExternalStringLatin1");
+  API_ASSERT(JSNIGetStringLength(env, latin1) == length,
+             "JSNINewExternalStringLatin1");
+  JSNIStringView view;
+  JSNIGetStringView(env, latin1, &view);
+  API_ASSERT(view.encoding == JSNIOneByte && view.data == external_latin1,
+             "JSNINewExternalStringLatin1");
+  JSNIReleaseStringView(env, &view);
+
+  JSValueRef two_byte = JSNINewExternalString(
+    env, external_two_byte, 4, nativeReleaseString, &released_strings);
+  API_ASSERT(JSNIGetStringLength(env, two_byte) == 4, "JSNINewExternalString");
+  JSNIGetStringView(env, two_byte, &view);
+  API_ASSERT(view.encoding == JSNITwoByte && view.data == external_two_byte,
+             "JSNINewExternalString");
+  JSNIReleaseStringView(env, &view);
+  JSNIPopLocalScope(env);
+
+  RequestGC();
+  assert(released_strings == 2);
+}
+
 TEST(Symbol) {
   int argc = JSNIGetArgsLengthOfCallback(env, info);
   JSValueRef s;
@@ -622,6 +955,60 @@ TEST(CreateTypedArray) {
   JSNISetReturnValue(env, info, js_typed_array);
 }
 
+double float64_data[] = {1.5, 2.5, 3.5};
+
+TEST(TypedArrayTypes) {
+  JSValueRef float64_array =
+    JSNINewTypedArray(env, JsArrayTypeFloat64, float64_data, 3);
+  assert(JSNIGetTypedArrayType(env, float64_array) == JsArrayTypeFloat64);
+  assert(JSNIGetTypedArrayLength(env, float64_array) == 3);
+  assert(JSNIGetTypedArrayByteLength(env, float64_array) == 3 * sizeof(double));
+  assert(JSNIGetTypedArrayData(env, float64_array) == float64_data);
+
+  JSValueRef abuffer = JSNINewArrayBuffer(env, 16);
+  JSValueRef view =
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeInt32, abuffer, 4, 3);
+  assert(JSNIGetTypedArrayType(env, view) == JsArrayTypeInt32);
+  assert(JSNIGetTypedArrayLength(env, view) == 3);
+  assert(JSNIGetTypedArrayByteOffset(env, view) == 4);
+  assert(JSNIStrictEquals(env, JSNIGetTypedArrayBuffer(env, view), abuffer));
+  int32_t* view_data = static_cast<int32_t*>(JSNIGetTypedArrayData(env, view));
+  assert(view_data ==
+         reinterpret_cast<int32_t*>(JSNIGetArrayBufferData(env, abuffer)) + 1);
+
+  // Misaligned offset.
+  assert(JSNINewTypedArrayFromArrayBuffer(
+           env, JsArrayTypeInt32, abuffer, 2, 1) == NULL);
+  AssertHelper(env);
+  // Out of range.
+  assert(JSNINewTypedArrayFromArrayBuffer(
+           env, JsArrayTypeInt32, abuffer, 4, 4) == NULL);
+  AssertHelper(env);
+  // Byte length overflow.
+  assert(JSNINewTypedArray(
+           env, JsArrayTypeFloat64, NULL, SIZE_MAX / 8 + 1) == NULL);
+  AssertHelper(env);
+
+  JSValueRef arrays[] = {
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeInt8, abuffer, 0, 16),
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeUint8Clamped, abuffer, 0, 16),
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeInt16, abuffer, 0, 8),
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeUint16, abuffer, 0, 8),
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeUint32, abuffer, 0, 4),
+    JSNINewTypedArrayFromArrayBuffer(env, JsArrayTypeFloat32, abuffer, 0, 4),
+  };
+  JsTypedArrayType types[] = {
+    JsArrayTypeInt8, JsArrayTypeUint8Clamped, JsArrayTypeInt16,
+    JsArrayTypeUint16, JsArrayTypeUint32, JsArrayTypeFloat32,
+  };
+  for (size_t i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+    assert(JSNIGetTypedArrayType(env, arrays[i]) == types[i]);
+    assert(JSNIGetTypedArrayByteLength(env, arrays[i]) == 16);
+  }
+
+  JSNISetReturnValue(env, info, float64_array);
+}
+
 TEST(IsArray) {
   JSValueRef check = JSNIGetArgOfCallback(env, info, 0);
   assert(JSNIIsArray(env, check));
@@ -656,6 +1043,221 @@ TEST(NewTarget) {
   JSNISetReturnValue(env, info, new_target);
 }
 
+// The address is unique to this module.
+static const int kInstanceDataKey = 0;
+
+struct Point {
+  double x;
+  double y;
+};
+
+Point* UnwrapPoint(JSNIEnv* env, JSNICallbackInfo info) {
+  return static_cast<Point*>(
+    JSNIGetInternalField(env, JSNIGetThisOfCallback(env, info), 0));
+}
+
+void DeletePoint(JSNIEnv* env, void* data) {
+  delete static_cast<Point*>(data);
+}
+
+void PointConstructor(JSNIEnv* env, JSNICallbackInfo info) {
+  Point* point = new Point();
+  point->x = JSNIToCDouble(env, JSNIGetArgOfCallback(env, info, 0));
+  point->y = JSNIToCDouble(env, JSNIGetArgOfCallback(env, info, 1));
+  JSValueRef self = JSNIGetThisOfCallback(env, info);
+  JSNISetInternalField(env, self, 0, point);
+  JSGlobalValueRef global = JSNINewGlobalValue(env, self);
+  JSNISetGCCallback(env, global, point, DeletePoint);
+  JSNIDeleteGlobalValue(env, global);
+}
+
+void PointSum(JSNIEnv* env, JSNICallbackInfo info) {
+  Point* point = UnwrapPoint(env, info);
+  JSNISetReturnValue(env, info, JSNINewNumber(env, point->x + point->y));
+}
+
+void PointGetX(JSNIEnv* env, JSNICallbackInfo info) {
+  assert(JSNIGetDataOfCallback(env, info) == &kInstanceDataKey);
+  JSNISetReturnValue(env, info, JSNINewNumber(env, UnwrapPoint(env, info)->x));
+}
+
+void PointGetY(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info, JSNINewNumber(env, UnwrapPoint(env, info)->y));
+}
+
+void PointSetX(JSNIEnv* env, JSNICallbackInfo info) {
+  UnwrapPoint(env, info)->x =
+    JSNIToCDouble(env, JSNIGetArgOfCallback(env, info, 0));
+}
+
+TEST(DefineClass) {
+  static const JSNIMethodDescriptor methods[] = {
+    {"sum", PointSum, JSNINone},
+  };
+  static const JSNIAccessorDescriptor accessors[] = {
+    {"x", PointGetX, PointSetX, JSNINone,
+     const_cast<int*>(&kInstanceDataKey)},
+  };
+  static const JSNIAccessorDescriptor instance_accessors[] = {
+    {"y", PointGetY, NULL, JSNIReadOnly, NULL},
+  };
+  JSNIClassDescriptor descriptor = {
+    "Point", PointConstructor, 1, methods, 1, accessors, 1,
+    instance_accessors, 1, NULL, NULL
+  };
+  JSValueRef constructor = JSNIDefineClass(env, &descriptor);
+  assert(JSNIIsFunction(env, constructor));
+  assert(JSNIStrictEquals(env, constructor, JSNIDefineClass(env, &descriptor)));
+  // Another descriptor for the same constructor.
+  JSNIClassDescriptor other = descriptor;
+  other.internal_field_count = 2;
+  assert(JSNIDefineClass(env, &other) == NULL);
+  AssertHelper(env);
+  other = descriptor;
+  other.name = NULL;
+  assert(JSNIDefineClass(env, &other) == NULL);
+  AssertHelper(env);
+
+  JSValueRef argv[] = {JSNINewNumber(env, 1), JSNINewNumber(env, 2)};
+  JSValueRef point = JSNINewInstance(env, constructor, 2, argv);
+  assert(JSNIInternalFieldCount(env, point) == 1);
+  assert(JSNIInstanceOf(env, point, constructor));
+  JSNISetReturnValue(env, info, constructor);
+}
+
+// A native table whose rows are produced lazily by the interceptors.
+struct TableRow {
+  const char* name;
+  double value;
+  bool present;
+};
+
+static TableRow table_rows[] = {
+  {"a", 1, true}, {"b", 2, true}, {"c", 3, true},
+};
+
+TableRow* FindTableRow(JSNIEnv* env, JSNICallbackInfo info) {
+  char name[8];
+  JSValueRef property = JSNIGetPropertyOfCallback(env, info);
+  if (JSNIGetDataOfCallback(env, info) != table_rows ||
+      !JSNIIsString(env, property) ||
+      JSNIWriteStringUtf8(env, property, name, sizeof(name)) >= sizeof(name)) {
+    return nullptr;
+  }
+  for (size_t i = 0; i < sizeof(table_rows) / sizeof(table_rows[0]); i++) {
+    if (table_rows[i].present && strcmp(table_rows[i].name, name) == 0) {
+      return &table_rows[i];
+    }
+  }
+  return nullptr;
+}
+
+void TableGetter(JSNIEnv* env, JSNICallbackInfo info) {
+  TableRow* row = FindTableRow(env, info);
+  if (row != nullptr) {
+    JSNISetReturnValue(env, info, JSNINewNumber(env, row->value));
+  }
+}
+
+void TableSetter(JSNIEnv* env, JSNICallbackInfo info) {
+  assert(JSNIGetArgsLengthOfCallback(env, info) == 1);
+  TableRow* row = FindTableRow(env, info);
+  if (row != nullptr) {
+    JSValueRef value = JSNIGetArgOfCallback(env, info, 0);
+    row->value = JSNIToCDouble(env, value);
+    JSNISetReturnValue(env, info, value);
+  }
+}
+
+void TableQuery(JSNIEnv* env, JSNICallbackInfo info) {
+  if (FindTableRow(env, info) != nullptr) {
+    JSNISetReturnValue(env, info, JSNINewNumber(env, JSNINone));
+  }
+}
+
+void TableDeleter(JSNIEnv* env, JSNICallbackInfo info) {
+  TableRow* row = FindTableRow(env, info);
+  if (row != nullptr) {
+    row->present = false;
+    JSNISetReturnValue(env, info, JSNINewBoolean(env, true));
+  }
+}
+
+void TableEnumerator(JSNIEnv* env, JSNICallbackInfo info) {
+  assert(JSNIGetPropertyOfCallback(env, info) == nullptr);
+  JSValueRef names = JSNINewArray(env, 0);
+  size_t length = 0;
+  for (size_t i = 0; i < sizeof(table_rows) / sizeof(table_rows[0]); i++) {
+    if (table_rows[i].present) {
+      JSNISetArrayElement(env, names, length++,
+                          JSNINewStringFromUtf8(env, table_rows[i].name, -1));
+    }
+  }
+  JSNISetReturnValue(env, info, names);
+}
+
+void SquareGetter(JSNIEnv* env, JSNICallbackInfo info) {
+  double index = JSNIToCDouble(env, JSNIGetPropertyOfCallback(env, info));
+  if (index < 10) {
+    JSNISetReturnValue(env, info, JSNINewNumber(env, index * index));
+  } else if (index == 13) {
+    JSNIThrowErrorException(env, "unlucky index");
+  }
+}
+
+void SquareEnumerator(JSNIEnv* env, JSNICallbackInfo info) {
+  JSValueRef indices = JSNINewArray(env, 0);
+  for (int i = 0; i < 10; i++) {
+    JSNISetArrayElement(env, indices, i, JSNINewNumber(env, i));
+  }
+  JSNISetReturnValue(env, info, indices);
+}
+
+void TableConstructor(JSNIEnv* env, JSNICallbackInfo info) {
+}
+
+TEST(Interceptor) {
+  // The test deletes and assigns rows, start from the initial table.
+  for (size_t i = 0; i < sizeof(table_rows) / sizeof(table_rows[0]); i++) {
+    table_rows[i].value = i + 1;
+    table_rows[i].present = true;
+  }
+  static const JSNIInterceptorDescriptor named = {
+    TableGetter, TableSetter, TableQuery, TableDeleter, TableEnumerator,
+    table_rows
+  };
+  static const JSNIInterceptorDescriptor indexed = {
+    SquareGetter, NULL, NULL, NULL, SquareEnumerator, NULL
+  };
+  JSNIClassDescriptor descriptor = {
+    "Table", TableConstructor, 0, NULL, 0, NULL, 0, NULL, 0,
+    &named, &indexed
+  };
+  JSNISetReturnValue(env, info, JSNIDefineClass(env, &descriptor));
+}
+
+void ReturnString(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info, JSNINewStringFromUtf8(env, "wrong", -1));
+}
+
+void ReturnNumber(JSNIEnv* env, JSNICallbackInfo info) {
+  JSNISetReturnValue(env, info, JSNINewNumber(env, 1));
+}
+
+void BadTableConstructor(JSNIEnv* env, JSNICallbackInfo info) {
+}
+
+TEST(BadInterceptor) {
+  static const JSNIInterceptorDescriptor named = {
+    NULL, NULL, ReturnString, ReturnNumber, ReturnNumber, NULL
+  };
+  JSNIClassDescriptor descriptor = {
+    "BadTable", BadTableConstructor, 0, NULL, 0, NULL, 0, NULL, 0,
+    &named, NULL
+  };
+  JSNISetReturnValue(env, info, JSNIDefineClass(env, &descriptor));
+}
+
 TEST(StrictEquals) {
   JSValueRef args_0 = JSNIGetArgOfCallback(env, info, 0);
   JSValueRef args_1 = JSNIGetArgOfCallback(env, info, 1);
@@ -675,15 +1277,239 @@ TEST(ArrayBuffer) {
   API_ASSERT_S(JSNIGetArrayBufferData(env, abuffer2) == data);
 }
 
+int finalized_buffers = 0;
+int finalize_buffer_hint = 0;
+void nativeFinalizeBuffer(JSNIEnv* env, void* data, void* hint) {
+  assert(hint == &finalize_buffer_hint);
+  free(data);
+  finalized_buffers += 1;
+}
+
+TEST(ArrayBufferWithFinalizer) {
+  JSNIPushLocalScope(env);
+  const size_t length = 1024 * 1024;
+  void* data = malloc(length);
+  JSValueRef abuffer = JSNINewArrayBufferWithFinalizer(
+    env, data, length, nativeFinalizeBuffer, &finalize_buffer_hint);
+  API_ASSERT_S(JSNIIsArrayBuffer(env, abuffer));
+  API_ASSERT_S(JSNIGetArrayBufferLength(env, abuffer) == length);
+  API_ASSERT_S(JSNIGetArrayBufferData(env, abuffer) == data);
+  JSNIPopLocalScope(env);
+
+  RequestGC();
+  assert(finalized_buffers == 1);
+}
+
 TEST(GetPropertyNames) {
   JSValueRef object = JSNIGetArgOfCallback(env, info, 0);
   JSValueRef names_array = JSNIGetPropertyNames(env, object);
   JSNISetReturnValue(env, info, names_array);
 }
 
+struct AsyncSum {
+  int input;
+  int sleep_ms;
+  int result;
+  JSGlobalValueRef callback;
+  JSNIAsyncWork work;
+};
+
+void ExecuteAsyncSum(void* data) {
+  AsyncSum* sum = static_cast<AsyncSum*>(data);
+  usleep(sum->sleep_ms * 1000);
+  sum->result = 0;
+  for (int i = 1; i <= sum->input; i++) {
+    sum->result += i;
+  }
+}
+
+void CompleteAsyncSum(JSNIEnv* env, JSNIAsyncStatus status, void* data) {
+  AsyncSum* sum = static_cast<AsyncSum*>(data);
+  JSValueRef callback = JSNIGetGlobalValue(env, sum->callback);
+  JSValueRef argv[] = {
+    JSNINewBoolean(env, status == JSNIAsyncCancelled),
+    JSNINewNumber(env, sum->result),
+  };
+  JSNICallFunction(env, callback, JSNINewUndefined(env), 2, argv);
+  JSNIDeleteGlobalValue(env, sum->callback);
+  JSNIDeleteAsyncWork(env, sum->work);
+  delete sum;
+}
+
+TEST(SetAsyncWorkPoolSize) {
+  size_t size = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 0));
+  JSNISetReturnValue(env, info,
+                     JSNINewBoolean(env, JSNISetAsyncWorkPoolSize(env, size)));
+}
+
+TEST(AsyncWork) {
+  AsyncSum* sum = new AsyncSum();
+  sum->input = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 0));
+  sum->sleep_ms = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 1));
+  sum->result = -1;
+  sum->callback = JSNINewGlobalValue(env, JSNIGetArgOfCallback(env, info, 2));
+  sum->work = JSNINewAsyncWork(env, ExecuteAsyncSum, CompleteAsyncSum, sum);
+  assert(JSNIQueueAsyncWork(env, sum->work));
+  // Already queued.
+  assert(!JSNIQueueAsyncWork(env, sum->work));
+
+  bool cancel = JSNIToCBool(env, JSNIGetArgOfCallback(env, info, 3));
+  bool cancelled = cancel && JSNICancelAsyncWork(env, sum->work);
+  JSNISetReturnValue(env, info, JSNINewBoolean(env, cancelled));
+}
+
+struct PromiseSum {
+  int input;
+  int result;
+  JSNIDeferred deferred;
+  JSNIAsyncWork work;
+};
+
+void ExecutePromiseSum(void* data) {
+  PromiseSum* sum = static_cast<PromiseSum*>(data);
+  sum->result = 0;
+  for (int i = 1; i <= sum->input; i++) {
+    sum->result += i;
+  }
+}
+
+void CompletePromiseSum(JSNIEnv* env, JSNIAsyncStatus status, void* data) {
+  PromiseSum* sum = static_cast<PromiseSum*>(data);
+  if (sum->input >= 0) {
+    JSNIResolveDeferred(env, sum->deferred, JSNINewNumber(env, sum->result));
+  } else {
+    JSValueRef reason = JSNINewStringFromUtf8(env, "negative input", -1);
+    JSNIRejectDeferred(env, sum->deferred, reason);
+  }
+  JSNIDeleteAsyncWork(env, sum->work);
+  delete sum;
+}
+
+TEST(Promise) {
+  PromiseSum* sum = new PromiseSum();
+  sum->input = JSNIToInt32(env, JSNIGetArgOfCallback(env, info, 0));
+  JSValueRef promise = JSNINewPromise(env, &sum->deferred);
+  assert(JSNIIsPromise(env, promise));
+  assert(!JSNIIsPromise(env, JSNINewObject(env)));
+  sum->work = JSNINewAsyncWork(env, ExecutePromiseSum, CompletePromiseSum, sum);
+  JSNIQueueAsyncWork(env, sum->work);
+  JSNISetReturnValue(env, info, promise);
+}
+
+const int kProducerCalls = 1000;
+const size_t kMaxQueueSize = 16;
+
+void CallJSWithNumber(JSNIEnv* env, JSValueRef func, void* context, void* data) {
+  JSValueRef argv[] = {
+    JSNINewNumber(env, static_cast<int>(reinterpret_cast<intptr_t>(data))),
+  };
+  JSNICallFunction(env, func, JSNINewUndefined(env), 1, argv);
+}
+
+void FinalizeThreadSafeFunction(JSNIEnv* env, void* context, void* hint) {
+  JSGlobalValueRef finish = static_cast<JSGlobalValueRef>(context);
+  JSNICallFunction(env, JSNIGetGlobalValue(env, finish),
+                   JSNINewUndefined(env), 0, NULL);
+  JSNIDeleteGlobalValue(env, finish);
+}
+
+void ProduceCalls(JSNIThreadSafeFunction tsfn) {
+  for (int i = 1; i <= kProducerCalls; i++) {
+    JSNICallThreadSafeFunction(tsfn, reinterpret_cast<void*>(i), true);
+  }
+  JSNIReleaseThreadSafeFunction(tsfn);
+}
+
+TEST(ThreadSafeFunction) {
+  JSValueRef func = JSNIGetArgOfCallback(env, info, 0);
+  JSGlobalValueRef finish =
+    JSNINewGlobalValue(env, JSNIGetArgOfCallback(env, info, 1));
+  JSNIThreadSafeFunction tsfn = JSNINewThreadSafeFunction(
+    env, func, kMaxQueueSize, CallJSWithNumber, finish,
+    FinalizeThreadSafeFunction);
+
+  // Nothing is dispatched while the loop thread is busy here.
+  for (size_t i = 0; i < kMaxQueueSize; i++) {
+    assert(JSNICallThreadSafeFunction(tsfn, NULL, false) == JSNIThreadSafeOK);
+  }
+  assert(JSNICallThreadSafeFunction(tsfn, NULL, false) ==
+         JSNIThreadSafeQueueFull);
+
+  // The producer blocks until the loop drains the queue.
+  assert(JSNIAcquireThreadSafeFunction(tsfn));
+  std::thread(ProduceCalls, tsfn).detach();
+  JSNIReleaseThreadSafeFunction(tsfn);
+}
+
+TEST(ThreadSafeFunctionException) {
+  JSValueRef func = JSNIGetArgOfCallback(env, info, 0);
+  bool call_func = JSNIToCBool(env, JSNIGetArgOfCallback(env, info, 1));
+  JSNIThreadSafeFunction tsfn = JSNINewThreadSafeFunction(
+    env, func, 0, call_func ? NULL : CallJSWithNumber, NULL, NULL);
+  assert(JSNICallThreadSafeFunction(tsfn, NULL, false) == JSNIThreadSafeOK);
+  JSNIReleaseThreadSafeFunction(tsfn);
+}
+
+void FreeCallCount(JSNIEnv* env, void* data, void* hint) {
+  delete static_cast<int*>(data);
+}
+
+TEST(InstanceData) {
+  int* count = static_cast<int*>(JSNIGetInstanceData(env, &kInstanceDataKey));
+  if (count == NULL) {
+    count = new int(0);
+    JSNISetInstanceData(env, &kInstanceDataKey, count, FreeCallCount, NULL);
+  }
+  assert(JSNIGetInstanceData(env, &kInstanceDataKey) == count);
+  assert(JSNIGetInstanceData(env, count) == NULL);
+  JSNISetReturnValue(env, info, JSNINewNumber(env, ++*count));
+}
+
+void WriteCleanupMessage(void* arg) {
+  const char* message = static_cast<const char*>(arg);
+  ssize_t written = write(STDOUT_FILENO, message, strlen(message));
+  (void)written;
+}
+
+void AbortCleanup(void* arg) {
+  abort();
+}
+
+TEST(CleanupHook) {
+  static const char kMessage[] = "cleanup\n";
+  JSNIAddCleanupHook(env, WriteCleanupMessage, const_cast<char*>(kMessage));
+  JSNIAddCleanupHook(env, AbortCleanup, NULL);
+  JSNIRemoveCleanupHook(env, AbortCleanup, NULL);
+}
+
+void WriteFinalizeMessage(JSNIEnv* env, void* context, void* hint) {
+  WriteCleanupMessage(context);
+}
+
+// Returns once the env is torn down.
+void CallFullQueue(JSNIThreadSafeFunction tsfn) {
+  JSNICallThreadSafeFunction(tsfn, NULL, true);
+}
+
+TEST(HoldThreadSafeFunction) {
+  static const char kMessage[] = "finalize\n";
+  JSValueRef func = JSNIGetArgOfCallback(env, info, 0);
+  JSNIThreadSafeFunction tsfn = JSNINewThreadSafeFunction(
+    env, func, 1, NULL, const_cast<char*>(kMessage), WriteFinalizeMessage);
+  // A call stays queued, the producer blocks on the full queue and the
+  // reference is never released.
+  assert(JSNICallThreadSafeFunction(tsfn, NULL, false) == JSNIThreadSafeOK);
+  assert(JSNIAcquireThreadSafeFunction(tsfn));
+  std::thread(CallFullQueue, tsfn).detach();
+}
+
 int JSNIInit(JSNIEnv* env, JSValueRef exports) {
   SET_METHOD(Version);
   SET_METHOD(Array);
+  SET_METHOD(ArrayElements);
+  SET_METHOD(NumberArray);
+  SET_METHOD(NumberArrayThrow);
+  SET_METHOD(NewArrayFromDoubles);
   SET_METHOD(Boolean);
   // ErrorInfo
   SET_METHOD(BoolCheck);
@@ -704,6 +1530,8 @@ int JSNIInit(JSNIEnv* env, JSValueRef exports) {
   SET_METHOD(NewRangeError);
   // Function
   SET_METHOD(NewNativeFunction);
+  SET_METHOD(GetFunction);
+  SET_METHOD(RegisterMethods);
   SET_METHOD(IsFunction);
   SET_METHOD(CallFunction);
   SET_METHOD(GetThis);
@@ -712,6 +1540,8 @@ int JSNIInit(JSNIEnv* env, JSValueRef exports) {
   SET_METHOD(GlobalGC);
   SET_METHOD(GCCallback);
   SET_METHOD(AcquireRelease);
+  SET_METHOD(WeakGlobal);
+  SET_METHOD(ExternalMemory);
   // InternalField
   SET_METHOD(Hidden);
   // LocalScope
@@ -728,17 +1558,33 @@ int JSNIInit(JSNIEnv* env, JSValueRef exports) {
   // Object
   SET_METHOD(Object);
   SET_METHOD(GetProto);
+  SET_METHOD(PropertyKey);
   // Property
   SET_METHOD(DefineProperty);
   SET_METHOD(DefineProperty2);
+  SET_METHOD(DefineProperties);
   SET_METHOD(GetPropertyNames);
+  // AsyncWork
+  SET_METHOD(SetAsyncWorkPoolSize);
+  SET_METHOD(AsyncWork);
+  SET_METHOD(ThreadSafeFunction);
+  SET_METHOD(ThreadSafeFunctionException);
+  SET_METHOD(HoldThreadSafeFunction);
+  SET_METHOD(Promise);
+  SET_METHOD(InstanceData);
+  SET_METHOD(CleanupHook);
   // String
   SET_METHOD(Utf8);
   SET_METHOD(String);
+  SET_METHOD(Latin1);
+  SET_METHOD(WriteStringUtf8);
+  SET_METHOD(StringView);
+  SET_METHOD(ExternalString);
   // Symbol
   SET_METHOD(Symbol);
   // TypedArray
   SET_METHOD(CreateTypedArray);
+  SET_METHOD(TypedArrayTypes);
   SET_METHOD(IsArray);
   SET_METHOD(IsExternailized);
   // Undefined
@@ -747,10 +1593,14 @@ int JSNIInit(JSNIEnv* env, JSValueRef exports) {
   SET_METHOD(Instance);
   // NewTarget
   SET_METHOD(NewTarget);
+  SET_METHOD(DefineClass);
+  SET_METHOD(Interceptor);
+  SET_METHOD(BadInterceptor);
   // StrictEquals
   SET_METHOD(StrictEquals);
   // ArrayBuffer
   SET_METHOD(ArrayBuffer);
+  SET_METHOD(ArrayBufferWithFinalizer);
 
   return JSNI_VERSION_2_3;
 }
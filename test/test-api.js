@@ -38,6 +38,11 @@ function testInNativeOnly() {
   testVersion();
 }
 
+function testInstanceData() {
+  assert.equal(native.testInstanceData(), 1);
+  assert.equal(native.testInstanceData(), 2);
+}
+
 function testArray() {
   var arr = [];
   var obj0 = {p0: 100};
@@ -47,6 +52,34 @@ function testArray() {
   var new_array = native.testArray(arr);
   assert(new_array[0] === obj0);
   assert(new_array[1] === obj1);
+
+  var elements = native.testArrayElements([1, 2, 3, 4]);
+  assert.deepEqual(elements, [4, 3, 2, 1, 2, 3]);
+
+  var doubles = [];
+  for (var i = 0; i < 100; i++) {
+    doubles.push(i + 0.5);
+  }
+  var ints = native.testNumberArray(doubles, [1, , 3]);
+  assert.equal(ints.length, 100);
+  assert.equal(ints[99], 99);
+  var bad = { valueOf: function() { throw new Error('bad element'); } };
+  var longBad = doubles.slice();
+  longBad[50] = bad;
+  native.testNumberArrayThrow([1, bad, 3], longBad);
+  // Bulk copies keep calling the builtin set once it is patched.
+  var typedArrayPrototype = Object.getPrototypeOf(Float64Array.prototype);
+  var originalSet = typedArrayPrototype.set;
+  typedArrayPrototype.set = function() {
+    throw new Error('patched set');
+  };
+  try {
+    ints = native.testNumberArray(doubles, [1, , 3]);
+  } finally {
+    typedArrayPrototype.set = originalSet;
+  }
+  assert.equal(ints[99], 99);
+  assert.deepEqual(native.testNewArrayFromDoubles(), [0.5, 1.5, 2.5]);
 }
 
 function testBoolean() {
@@ -146,6 +179,18 @@ function testFunction() {
   var ret1 = native.testCallFunction(func);
   assert(ret1 === 200);
 
+  var cached_func = native.testGetFunction();
+  assert(cached_func === native.testGetFunction());
+  assert(cached_func !== func);
+  assert(cached_func(300) === 300);
+
+  var methods = {};
+  native.testRegisterMethods(methods);
+  assert(methods.native(1) === 1);
+  assert(methods.hidden(2) === 2);
+  assert(methods.native.name === 'native');
+  assert(Object.keys(methods).length === 1);
+
   var this_value = native.testGetThis();
   assert(this_value === native);
 }
@@ -155,6 +200,8 @@ function testGlobalRef() {
   native.testGlobalGC();
   native.testGCCallback();
   native.testAcquireRelease();
+  native.testWeakGlobal();
+  native.testExternalMemory();
 }
 
 function testInternalField() {
@@ -185,6 +232,12 @@ function testObject() {
   var protoObj = {proto: 'proto'};
   Object.setPrototypeOf(obj, protoObj);
   assert(protoObj === native.testGetProto(obj));
+
+  var keyed = {value: 100};
+  native.testPropertyKey(keyed);
+  assert(keyed.keyed === 300);
+  keyed.keyed = 0;
+  assert(keyed.keyed === 300);
 }
 
 function testProperty() {
@@ -202,11 +255,27 @@ function testProperty() {
   var obj_2 = {};
   native.testDefineProperty2(obj_2);
   assert(obj_2.abc_2 === 'Hello world!');
+
+  var obj_3 = {};
+  native.testDefineProperties(obj_3);
+  assert.equal(obj_3.answer, 42);
+  obj_3.answer = 0;
+  assert.equal(obj_3.answer, 42);
+  obj_3.count = 7;
+  assert.equal(obj_3.count, 7);
+  assert.equal(obj_3.count2, 7);
 }
 
 function testString() {
   assert(native.testUtf8('string') === 'hello, world!');
   native.testString();
+  assert(native.testLatin1() === 'caf\u00e9');
+  assert(native.testWriteStringUtf8('h\u00e9llo, \u4e16\u754c') ===
+         'h\u00e9llo, \u4e16\u754c');
+  // A cons string is flattened by the view.
+  var hello = 'hel';
+  native.testStringView(hello + 'lo, world and a little more', '\u4e2d'.repeat(100));
+  native.testExternalString();
 }
 
 function testSymbol() {
@@ -231,6 +300,11 @@ function testTypedArray() {
   assert(typedArray[1] === 2);
   assert(typedArray[2] === 3);
 
+  var float64Array = native.testTypedArrayTypes();
+  assert(float64Array.constructor === Float64Array);
+  assert(float64Array[0] === 1.5);
+  assert(float64Array[2] === 3.5);
+
   var arr = [];
   native.testIsArray(arr);
 
@@ -253,6 +327,58 @@ function testNewTarget() {
   assert(constr == newTarget);
 }
 
+function testDefineClass() {
+  var Point = native.testDefineClass();
+  assert.equal(Point.name, 'Point');
+  var a = new Point(1, 2);
+  var b = new Point(3, 4);
+  assert(a instanceof Point);
+  assert.equal(Object.getPrototypeOf(a), Object.getPrototypeOf(b));
+  assert(!a.hasOwnProperty('x'));
+  assert.deepEqual(Object.keys(a), ['y']);
+  assert.equal(b.y, 4);
+  b.y = 0;
+  assert.equal(b.y, 4);
+  assert.equal(a.sum(), 3);
+  assert.equal(b.x, 3);
+  a.x = 5;
+  assert.equal(a.x, 5);
+  assert.equal(a.sum(), 7);
+  assert.throws(function() { Point(1, 2); }, TypeError);
+  assert.throws(function() { a.sum.call({}); }, TypeError);
+  assert.throws(function() { return Point.prototype.x; }, TypeError);
+}
+
+function testInterceptor() {
+  var Table = native.testInterceptor();
+  var t = new Table();
+  assert.equal(t.a, 1);
+  assert.equal(t.c, 3);
+  assert.equal(t.missing, undefined);
+  assert('b' in t);
+  assert(!('missing' in t));
+  assert.deepEqual(Object.keys(t).slice(10), ['a', 'b', 'c']);
+  t.b = 20;
+  assert.equal(t.b, 20);
+  assert(!t.hasOwnProperty('missing'));
+  t.missing = 5;
+  assert.equal(t.missing, 5);
+  assert(delete t.a);
+  assert.equal(t.a, undefined);
+  assert(!('a' in t));
+  assert.equal(t[3], 9);
+  assert.equal(t[10], undefined);
+  assert.throws(function() { return t[13]; }, /unlucky index/);
+  assert.equal(Object.keys(t).length, 13);
+
+  // Results of the wrong type throw instead of reaching V8.
+  var BadTable = native.testBadInterceptor();
+  var b = new BadTable();
+  assert.throws(function() { return 'x' in b; }, TypeError);
+  assert.throws(function() { return delete b.x; }, TypeError);
+  assert.throws(function() { return Object.keys(b); }, TypeError);
+}
+
 function testStrictEquals() {
   var val0 = '0';
   var val1 = '0';
@@ -262,6 +388,7 @@ function testStrictEquals() {
 
 function testArrayBuffer() {
   native.testArrayBuffer();
+  native.testArrayBufferWithFinalizer();
 }
 
 function testGetPropertyNames() {
@@ -273,8 +400,181 @@ function testGetPropertyNames() {
   }
 }
 
+function testAsyncWork(done) {
+  assert(native.testSetAsyncWorkPoolSize(2));
+  var results = {};
+  var pending = 3;
+  function complete(name) {
+    return function(cancelled, result) {
+      results[name] = {cancelled: cancelled, result: result};
+      if (--pending === 0) {
+        try {
+          assert.deepEqual(results.first, {cancelled: false, result: 5050});
+          assert.deepEqual(results.second, {cancelled: false, result: 20100});
+          assert.deepEqual(results.third, {cancelled: true, result: -1});
+          // The pool has started.
+          assert(!native.testSetAsyncWorkPoolSize(4));
+          done();
+        } catch (e) {
+          done(e);
+        }
+      }
+    };
+  }
+  // Both workers are busy while the third work is cancelled.
+  assert(!native.testAsyncWork(100, 50, complete('first'), false));
+  assert(!native.testAsyncWork(200, 50, complete('second'), false));
+  assert(native.testAsyncWork(300, 0, complete('third'), true));
+}
+
+function testAsyncWorkException(done) {
+  process.once('uncaughtException', function(e) {
+    try {
+      assert.equal(e.message, 'boom-from-complete');
+      // The exception does not leak into later native calls.
+      native.testVersion();
+      done();
+    } catch (e) {
+      done(e);
+    }
+  });
+  native.testAsyncWork(10, 0, function() {
+    throw new Error('boom-from-complete');
+  }, false);
+}
+
+function testThreadSafeFunction(done) {
+  var calls = 0;
+  var sum = 0;
+  native.testThreadSafeFunction(function(value) {
+    calls++;
+    sum += value;
+  }, function() {
+    try {
+      // 16 calls from the loop thread, 1000 from the producer thread.
+      assert.equal(calls, 1016);
+      assert.equal(sum, 1000 * 1001 / 2);
+      done();
+    } catch (e) {
+      done(e);
+    }
+  });
+}
+
+function testThreadSafeFunctionException(done) {
+  var messages = [];
+  function onException(e) {
+    messages.push(e.message);
+    if (messages.length < 2) {
+      return;
+    }
+    process.removeListener('uncaughtException', onException);
+    try {
+      assert.deepEqual(messages.sort(), ['boom-from-call-js', 'boom-from-func']);
+      // The exceptions do not leak into later native calls.
+      native.testVersion();
+      done();
+    } catch (e) {
+      done(e);
+    }
+  }
+  process.on('uncaughtException', onException);
+  native.testThreadSafeFunctionException(function() {
+    throw new Error('boom-from-call-js');
+  }, false);
+  native.testThreadSafeFunctionException(function() {
+    throw new Error('boom-from-func');
+  }, true);
+}
+
+function testPromise(done) {
+  var resolved = native.testPromise(100);
+  assert(resolved instanceof Promise);
+  var rejected = native.testPromise(-1);
+  resolved.then(function(result) {
+    assert.equal(result, 5050);
+    return rejected;
+  }).then(function() {
+    done(new Error('should be rejected'));
+  }, function(reason) {
+    assert.equal(reason, 'negative input');
+    done();
+  }).catch(done);
+}
+
+function testWorkerThreads(done) {
+  var path = require('path');
+  var index = JSON.stringify(path.resolve(__dirname, '../index'));
+  var addon = JSON.stringify(
+    path.resolve(__dirname, 'build', buildType, 'test.node'));
+  // Every worker loads the native module into its own isolate and env.
+  var workerScript =
+    'const { parentPort } = require("worker_threads");' +
+    'require(' + index + ');' +
+    'const native = nativeLoad(' + addon + ');' +
+    'const input = require("worker_threads").workerData;' +
+    'native.testCleanupHook();' +
+    'native.testPromise(input).then(r => parentPort.postMessage(r));';
+  var mainScript =
+    'const { Worker } = require("worker_threads");' +
+    'const results = [];' +
+    '[100, 200].forEach(function(input) {' +
+    '  const w = new Worker(' + JSON.stringify(workerScript) +
+    '                       , { eval: true, workerData: input });' +
+    '  w.on("message", function(r) {' +
+    '    results.push(r);' +
+    '    if (results.length === 2) console.log(results.sort().join());' +
+    '  });' +
+    '});';
+  // worker_threads is behind a flag in node 10.
+  require('child_process').execFile(
+    process.execPath, ['--experimental-worker', '-e', mainScript],
+    function(error, stdout) {
+      try {
+        assert.ifError(error);
+        // The cleanup hooks write once per worker when it shuts down.
+        var lines = stdout.trim().split('\n').sort();
+        assert.deepEqual(lines, ['20100,5050', 'cleanup', 'cleanup']);
+        done();
+      } catch (e) {
+        done(e);
+      }
+    });
+}
+
+function testWorkerExit(done) {
+  var path = require('path');
+  var index = JSON.stringify(path.resolve(__dirname, '../index'));
+  var addon = JSON.stringify(
+    path.resolve(__dirname, 'build', buildType, 'test.node'));
+  // The worker exits while its async work is still running and a
+  // thread-safe function is held.
+  var workerScript =
+    'require(' + index + ');' +
+    'const native = nativeLoad(' + addon + ');' +
+    'native.testAsyncWork(100, 200, function() {}, false);' +
+    'native.testHoldThreadSafeFunction(function() {});' +
+    'process.exit(0);';
+  var mainScript =
+    'const { Worker } = require("worker_threads");' +
+    'new Worker(' + JSON.stringify(workerScript) + ', { eval: true })' +
+    '  .on("exit", function(code) { console.log("exit " + code); });';
+  require('child_process').execFile(
+    process.execPath, ['--experimental-worker', '-e', mainScript],
+    function(error, stdout) {
+      try {
+        assert.ifError(error);
+        assert.deepEqual(stdout.trim().split('\n'), ['finalize', 'exit 0']);
+        done();
+      } catch (e) {
+        done(e);
+      }
+    });
+}
+
 var test_cases = [
   testInNativeOnly,
+  testInstanceData,
   testArray,
   testBoolean,
   testErrorInfo,
@@ -293,9 +593,18 @@ var test_cases = [
   testUndefined,
   testInstance,
   testNewTarget,
+  testDefineClass,
+  testInterceptor,
   testStrictEquals,
   testArrayBuffer,
   testGetPropertyNames,
+  testAsyncWork,
+  testAsyncWorkException,
+  testThreadSafeFunction,
+  testThreadSafeFunctionException,
+  testPromise,
+  testWorkerThreads,
+  testWorkerExit,
 ];
 
 var report = {
@@ -331,28 +640,50 @@ function needDumpReport() {
   return false;
 }
 
-function runTest(test) {
-  try {
-    test();
+function runTest(test, next) {
+  function pass() {
     console.log(test.name + " passed(jsni).");
     report.pass_count += 1;
-  } catch (e) {
+    next();
+  }
+  function fail(e) {
     report.fail_count += 1;
     report.message += ' ' + test.name;
     console.log(e);
+    next();
+  }
+  try {
+    // Asynchronous tests take a callback to report completion.
+    if (test.length > 0) {
+      test(function(e) {
+        if (e) {
+          fail(e);
+        } else {
+          pass();
+        }
+      });
+      return;
+    }
+    test();
+    pass();
+  } catch (e) {
+    fail(e);
   }
 }
 
 function run() {
-  test_cases.forEach(function(test) {
-    runTest(test);
-  });
-
-  if (needDumpReport()) {
-    dumpReportFile();
+  var index = 0;
+  function next() {
+    if (index < test_cases.length) {
+      runTest(test_cases[index++], next);
+      return;
+    }
+    if (needDumpReport()) {
+      dumpReportFile();
+    }
+    process.exit();
   }
+  next();
 }
 
 run();
-
-process.exit();